@@ -23,12 +23,22 @@
 #include "otsvm/PolynomialKernel.hxx"
 #include "otsvm/SigmoidKernel.hxx"
 #include "otsvm/LinearKernel.hxx"
+#include "otsvm/SVMKernelEngine.hxx"
 
 #include <openturns/Log.hxx>
 #include <openturns/SpecFunc.hxx>
 #include <openturns/LinearFunction.hxx>
+#include <openturns/ResourceMap.hxx>
+#include <openturns/TBBImplementation.hxx>
+#include <openturns/RandomGenerator.hxx>
+
+#include <algorithm>
+#include <random>
 
 #include "svm.h"
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+#include "otsvm/SVMSolverVector.hxx"
+#endif
 
 
 using namespace OT;
@@ -36,7 +46,78 @@ using namespace OT;
 namespace OTSVM
 {
 
-class LibSVMImplementation
+/* Rows of the sample classified at once */
+const UnsignedInteger ClassificationBlockSize = 256;
+
+/* Kernel values held at once by a thread classifying a block of rows */
+const UnsignedInteger VoteBufferSize = 65536;
+
+/* Buffers of the single point predictions, one set per thread so that a
+   model can be queried concurrently without allocation once they are grown */
+namespace
+{
+struct LibSVMScratch
+{
+  std::vector<svm_node> node;
+  std::vector<double> point;
+  std::vector<double> kernelValues;
+  std::vector<double> decisionValues;
+  std::vector<double> workspace;
+  std::vector<UnsignedInteger> votes;
+};
+
+LibSVMScratch & GetScratch()
+{
+  static thread_local LibSVMScratch scratch;
+  return scratch;
+}
+
+/* One-vs-one votes from the decision values, as svm_predict */
+void AddVotes(const double * decisionValues, const UnsignedInteger classNumber, UnsignedInteger * vote)
+{
+  UnsignedInteger p = 0;
+  for (UnsignedInteger i = 0; i < classNumber; ++ i)
+    for (UnsignedInteger j = i + 1; j < classNumber; ++ j)
+    {
+      if (decisionValues[p++] > 0)
+        ++ vote[i];
+      else
+        ++ vote[j];
+    }
+}
+
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+/* Independent trainings of the bundled libsvm, such as the one-vs-one
+   classifiers, scheduled by TBB, which also balances them with the
+   trainings of the cross validation they may belong to */
+struct LibSVMTrainingPolicy
+{
+  void (*body_)(int, void *);
+  void * data_;
+
+  LibSVMTrainingPolicy(void (*body)(int, void *), void * data)
+    : body_(body)
+    , data_(data)
+  {
+    // Nothing to do
+  }
+
+  inline void operator()(const TBBImplementation::BlockedRange<UnsignedInteger> & r) const
+  {
+    for (UnsignedInteger k = r.begin(); k != r.end(); ++ k)
+      body_(k, data_);
+  }
+}; /* end struct LibSVMTrainingPolicy */
+
+void LibSVMParallelFor(int n, void (*body)(int, void *), void * data)
+{
+  const LibSVMTrainingPolicy policy(body, data);
+  TBBImplementation::ParallelFor(0, n, policy);
+}
+#endif
+}
+
+class OTSVM_LOCAL LibSVMImplementation
 {
 public:
   /* Libsvm parameter */
@@ -48,10 +129,466 @@ public:
   /* Libsvm model */
   svm_model* p_model_ = nullptr;
 
+  /* Models of the outputs trained together, p_model_ being the selected one */
+  std::vector<svm_model *> models_;
+  Point outputKernelParameter_;
+
+  /* Release the models of the outputs */
+  void freeModels();
+
+  /* Values of the outputs at the training points, one column per output */
+  std::vector<double> outputs_;
+  UnsignedInteger outputNumber_ = 0;
+
   /* Libsvm node */
   svm_node* p_node_ = nullptr;
+
+  /* Kernel of the precomputed mode */
+  SVMKernel kernel_;
+
+  /* Normalized training points of the precomputed mode */
+  Sample normalizedInput_;
+
+  /* Normalized training points of the dense mode of the bundled libsvm, row-major */
+  std::vector<double> denseInput_;
+
+  /* Support vectors of the selected model, in its order, with the kernel
+     equivalent to the libsvm one */
+  Pointer<SVMKernelEngine> p_supportVectorEngine_;
+
+  /* Nodes of the support vectors of the precomputed models, which give
+     their position in the model instead of their serial number */
+  std::vector<svm_node> positionNodes_;
+
+  /* Point the support vectors of a trained precomputed model to their position */
+  void setPositionNodes(svm_model * model) const;
+
+  /* Set the support vectors after the selected model */
+  void setSupportVectors();
+
+  /* Whether the Gram matrix matches the kernel and the training points */
+  Bool gramUpToDate_ = false;
+
+  /* Dense Gram matrix handed to the bundled libsvm, in double or single precision */
+  std::vector<double> gramDouble_;
+  std::vector<float> gramFloat_;
+
+  /* Compute the Gram matrix of the training points if needed */
+  void computeGram();
+
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+  /* Hand a Gram matrix of the training points to the parameters */
+  void storeGram(const SymmetricMatrix & gram, svm_parameter & parameter);
+#endif
+
+  /* Set the number of threads of the solver before a training */
+  void setSolverThreads();
+
+  /* Set the kernel cache of each of the trainings run together */
+  void setCacheSize(svm_parameter & parameter, const UnsignedInteger trainingNumber) const;
+
+  /* Cross validation folds: perm holds the points fold by fold, from foldStart */
+  void drawFolds(const UnsignedInteger nFolds, std::vector<UnsignedInteger> & perm, std::vector<UnsignedInteger> & foldStart) const;
+
+  /* Cross validation errors of the cells of the tradeoff factors, in the inner
+     loop, and of the gammas, none meaning the gamma of the parameters, for
+     each of the outputs: error[cell * outputNumber + output] */
+  void crossValidate(const Point & tradeoffFactor,
+                     const Point & gamma,
+                     const std::vector<const double *> & outputs,
+                     const std::vector<UnsignedInteger> & perm,
+                     const std::vector<UnsignedInteger> & foldStart,
+                     Scalar * error);
+
+  /* Cross validation errors of the cells of a given set of parameters,
+     along the path of the tradeoff factors in the given order if any */
+  void runFolds(const svm_parameter & parameter,
+                const Point & tradeoffFactor,
+                const Point & gamma,
+                const std::vector<const double *> & outputs,
+                const std::vector<UnsignedInteger> & perm,
+                const std::vector<UnsignedInteger> & foldStart,
+                const Indices & path,
+                Scalar * error) const;
+
+  /* Number of OpenMP threads of the bundled solver, 0 for the OpenTURNS one */
+  UnsignedInteger threadNumber_ = 0;
+
+  /* Normalization of the training points */
+  Point inputMean_;
+  Point inputScale_;
+
+  /* Nodes of a point to be predicted, normalized on the fly */
+  void convertPoint(const Point & x, std::vector<svm_node> & node) const;
+
+  /* Prediction and decision values of a point through per-thread buffers */
+  Scalar predictPoint(const Point & x) const;
+
+  /* Nodes of the training point k to be predicted */
+  const svm_node * getTrainingNode(const UnsignedInteger k, std::vector<svm_node> & node) const;
+
+  /* Kernel equivalent to the libsvm one */
+  SVMKernel getKernel() const;
+  SVMKernel getKernel(const svm_parameter & parameter) const;
+
+  /* Normalized support vectors, in the order of the model */
+  Sample getSupportVectorSample() const;
+
+  /* One-vs-one votes of the points of a sample, row-major */
+  void computeVotes(const Sample & sample, std::vector<UnsignedInteger> & votes) const;
 };
 
+/* The Gram matrix is computed once for all the tradeoff factors: with the
+   bundled libsvm it is stored densely and the nodes only hold the serial
+   number of the points, otherwise it is written in the nodes in the
+   precomputed format of libsvm */
+void LibSVMImplementation::computeGram()
+{
+  if (gramUpToDate_)
+    return;
+  const SymmetricMatrix gram(kernel_.computeGram(normalizedInput_));
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+  storeGram(gram, parameter_);
+#else
+  const UnsignedInteger size = problem_.l;
+  for (UnsignedInteger j = 0; j < size; ++ j)
+    for (UnsignedInteger i = j; i < size; ++ i)
+    {
+      p_node_[i * (size + 2) + j + 1].value = gram(i, j);
+      p_node_[j * (size + 2) + i + 1].value = gram(i, j);
+    }
+#endif
+  gramUpToDate_ = true;
+}
+
+void LibSVMImplementation::freeModels()
+{
+  if (models_.empty())
+    return;
+  for (UnsignedInteger j = 0; j < models_.size(); ++ j)
+    if (models_[j])
+      svm_free_and_destroy_model(&models_[j]);
+  models_.clear();
+  p_model_ = nullptr;
+}
+
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+/* Dense storage of a Gram matrix in the precision of LibSVM-GramStorage */
+void LibSVMImplementation::storeGram(const SymmetricMatrix & gram, svm_parameter & parameter)
+{
+  const UnsignedInteger size = gram.getNbRows();
+  const String storage(ResourceMap::GetAsString("LibSVM-GramStorage"));
+  if (storage == "float")
+  {
+    gramDouble_.clear();
+    gramFloat_.resize(size * size);
+    for (UnsignedInteger j = 0; j < size; ++ j)
+      for (UnsignedInteger i = j; i < size; ++ i)
+        gramFloat_[i * size + j] = gramFloat_[j * size + i] = gram(i, j);
+    parameter.gram = gramFloat_.data();
+    parameter.gram_type = GRAM_FLOAT;
+  }
+  else if (storage == "double")
+  {
+    gramFloat_.clear();
+    gramDouble_.resize(size * size);
+    for (UnsignedInteger j = 0; j < size; ++ j)
+      for (UnsignedInteger i = j; i < size; ++ i)
+        gramDouble_[i * size + j] = gramDouble_[j * size + i] = gram(i, j);
+    parameter.gram = gramDouble_.data();
+    parameter.gram_type = GRAM_DOUBLE;
+  }
+  else
+    throw InvalidArgumentException(HERE) << "LibSVM: unknown Gram storage " << storage << ", expected double or float";
+  parameter.gram_ld = size;
+}
+#endif
+
+/* The OpenMP loops of the bundled solver use the OpenTURNS thread number
+   by default, so that they do not add up to the TBB threads. A driver
+   trained from a thread of a parallel loop should be set to one thread */
+void LibSVMImplementation::setSolverThreads()
+{
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+  parameter_.nr_thread = threadNumber_ > 0 ? threadNumber_ : TBBImplementation::GetNumberOfThreads();
+#endif
+}
+
+/* With LibSVM-AdaptiveCacheSize, the memory budget left by the Gram matrices
+   is split among the trainings actually running at the same time, that is
+   at most one per thread. A share larger than the full Q matrix of the
+   problem is cut down to it, and the solver then keeps all its columns.
+   Otherwise every training has the fixed LibSVM-CacheSize. The bundled
+   solver may store the columns in 16-bit types after LibSVM-CacheStorage,
+   which doubles the number of cached columns at the price of kernel values
+   rounded to 3 significant digits for bfloat16, and 4 for half */
+void LibSVMImplementation::setCacheSize(svm_parameter & parameter, const UnsignedInteger trainingNumber) const
+{
+  UnsignedInteger valueSize = sizeof(float);
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+  const String storage(ResourceMap::GetAsString("LibSVM-CacheStorage"));
+  if (storage == "float")
+    parameter.cache_type = CACHE_FLOAT;
+  else if (storage == "bfloat16")
+    parameter.cache_type = CACHE_BFLOAT16;
+  else if (storage == "half")
+    parameter.cache_type = CACHE_HALF;
+  else
+    throw InvalidArgumentException(HERE) << "LibSVM: unknown cache storage " << storage << ", expected float, bfloat16 or half";
+  if (parameter.cache_type != CACHE_FLOAT)
+    valueSize = sizeof(unsigned short);
+#endif
+  if (!ResourceMap::GetAsBool("LibSVM-AdaptiveCacheSize"))
+  {
+    parameter.cache_size = ResourceMap::GetAsUnsignedInteger("LibSVM-CacheSize");
+    return;
+  }
+  const Scalar megabyte = 1024.0 * 1024.0;
+  const Scalar budget = ResourceMap::GetAsUnsignedInteger("LibSVM-MemoryBudget") * megabyte;
+  const UnsignedInteger concurrency = std::max<UnsignedInteger>(1, std::min(trainingNumber, TBBImplementation::GetNumberOfThreads()));
+  const Scalar gramSize = gramDouble_.size() * sizeof(double) + gramFloat_.size() * sizeof(float);
+  const Scalar share = std::max(0.0, budget - gramSize) / concurrency;
+  // the solver needs at least two columns
+  const Scalar size = problem_.l;
+  const Scalar fullSize = (size + 2.0) * size * valueSize;
+  const Scalar minimumSize = 2.0 * (size + 2.0) * valueSize;
+  parameter.cache_size = std::max(std::min(share, fullSize), minimumSize) / megabyte;
+  LOGDEBUG(OSS() << "LibSVM: " << concurrency << " concurrent trainings of " << problem_.l << " points, cache of " << parameter.cache_size << " MB" << (share >= fullSize ? " holding the full Q matrix" : ""));
+}
+
+void LibSVMImplementation::convertPoint(const Point & x, std::vector<svm_node> & node) const
+{
+  const UnsignedInteger dimension = x.getDimension();
+  if (dimension != inputMean_.getDimension())
+    throw InvalidArgumentException(HERE) << "LibSVM: expected a point of dimension " << inputMean_.getDimension() << ", got " << dimension;
+  if (parameter_.kernel_type != PRECOMPUTED)
+  {
+    node.resize(dimension + 1);
+    for (UnsignedInteger i = 0; i < dimension; ++ i)
+    {
+      node[i].index = i + 1;
+      node[i].value = (x[i] - inputMean_[i]) * inputScale_[i];
+    }
+    node[dimension].index = -1;
+    return;
+  }
+  // kernel values against the support vectors, at their position in the model
+  LibSVMScratch & scratch = GetScratch();
+  scratch.point.resize(dimension);
+  for (UnsignedInteger i = 0; i < dimension; ++ i)
+    scratch.point[i] = (x[i] - inputMean_[i]) * inputScale_[i];
+  const UnsignedInteger size = p_model_->l;
+  scratch.kernelValues.resize(size);
+  p_supportVectorEngine_->computeKernelValues(scratch.point.data(), 0, size, scratch.kernelValues.data());
+  node.resize(size + 2);
+  node[0].index = 0;
+  node[0].value = 0.0;
+  for (UnsignedInteger k = 0; k < size; ++ k)
+  {
+    node[k + 1].index = k + 1;
+    node[k + 1].value = scratch.kernelValues[k];
+  }
+  node[size + 1].index = -1;
+}
+
+/* The nodes of the support vectors, which held their serial number in the
+   training points, now hold their position: a point to be predicted only
+   needs its kernel values against the support vectors */
+void LibSVMImplementation::setPositionNodes(svm_model * model) const
+{
+  for (SignedInteger k = 0; k < model->l; ++ k)
+    model->SV[k] = const_cast<svm_node *>(&positionNodes_[2 * k]);
+}
+
+void LibSVMImplementation::setSupportVectors()
+{
+  p_supportVectorEngine_ = new SVMKernelEngine(getKernel(), SupportVectorMatrix(getSupportVectorSample()), Point(p_model_->l, 1.0));
+}
+
+SVMKernel LibSVMImplementation::getKernel() const
+{
+  return getKernel(parameter_);
+}
+
+SVMKernel LibSVMImplementation::getKernel(const svm_parameter & parameter) const
+{
+  switch (parameter.kernel_type)
+  {
+    case POLY:
+      return PolynomialKernel(parameter.degree, parameter.gamma, parameter.coef0);
+    case RBF:
+      return NormalRBF(1.0 / std::sqrt(2.0 * parameter.gamma));
+    case SIGMOID:
+      return SigmoidKernel(parameter.gamma, parameter.coef0);
+    case LINEAR:
+      return LinearKernel();
+    case PRECOMPUTED:
+      return kernel_;
+    default:
+      throw InvalidArgumentException(HERE) << "LibSVM: unknown kernel type";
+  }
+}
+
+Sample LibSVMImplementation::getSupportVectorSample() const
+{
+  const UnsignedInteger dimension = inputMean_.getDimension();
+  const UnsignedInteger size = p_model_->l;
+  Sample result(size, dimension);
+  for (UnsignedInteger k = 0; k < size; ++ k)
+    if (parameter_.kernel_type == PRECOMPUTED)
+      result[k] = normalizedInput_[p_model_->sv_indices[k] - 1];
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+    else if (parameter_.dense)
+    {
+      const double * row = parameter_.dense + (p_model_->sv_indices[k] - 1) * parameter_.dense_ld;
+      for (UnsignedInteger i = 0; i < dimension; ++ i)
+        result(k, i) = row[i];
+    }
+#endif
+    else
+      for (const svm_node * node = p_model_->SV[k]; node->index != -1; ++ node)
+        result(k, node->index - 1) = node->value;
+  return result;
+}
+
+/* One-vs-one votes of a range of row blocks. The kernel values of the rows
+   of a block against all the support vectors are computed at once by the
+   engine into a per-thread buffer, then summed class pair by class pair
+   as in svm_predict_values */
+namespace
+{
+struct LibSVMVotePolicy
+{
+  const LibSVMImplementation & implementation_;
+  const Sample & input_;
+  const std::vector<UnsignedInteger> & start_;
+  UnsignedInteger * votes_;
+
+  LibSVMVotePolicy(const LibSVMImplementation & implementation,
+                   const Sample & input,
+                   const std::vector<UnsignedInteger> & start,
+                   UnsignedInteger * votes)
+    : implementation_(implementation)
+    , input_(input)
+    , start_(start)
+    , votes_(votes)
+  {
+    // Nothing to do
+  }
+
+  inline void operator()(const TBBImplementation::BlockedRange<UnsignedInteger> & r) const
+  {
+    const svm_model & model = *implementation_.p_model_;
+    const SVMKernelEngine & engine = *implementation_.p_supportVectorEngine_;
+    const UnsignedInteger size = input_.getSize();
+    const UnsignedInteger dimension = input_.getDimension();
+    const UnsignedInteger classNumber = model.nr_class;
+    const UnsignedInteger svNumber = model.l;
+    const Scalar * mean = implementation_.inputMean_.data();
+    const Scalar * scale = implementation_.inputScale_.data();
+    const UnsignedInteger rowNumber = std::max<UnsignedInteger>(1, std::min(ClassificationBlockSize, VoteBufferSize / std::max<UnsignedInteger>(1, svNumber)));
+    LibSVMScratch & scratch = GetScratch();
+    scratch.point.resize(dimension);
+    scratch.kernelValues.resize(rowNumber * svNumber);
+    scratch.decisionValues.resize(std::max<UnsignedInteger>(1, classNumber * (classNumber - 1) / 2));
+    for (UnsignedInteger block = r.begin(); block != r.end(); ++ block)
+    {
+      const UnsignedInteger blockEnd = std::min((block + 1) * ClassificationBlockSize, size);
+      for (UnsignedInteger i0 = block * ClassificationBlockSize; i0 < blockEnd; i0 += rowNumber)
+      {
+        const UnsignedInteger i1 = std::min(i0 + rowNumber, blockEnd);
+        for (UnsignedInteger i = i0; i < i1; ++ i)
+        {
+          const Scalar * x = &input_(i, 0);
+          for (UnsignedInteger k = 0; k < dimension; ++ k)
+            scratch.point[k] = (x[k] - mean[k]) * scale[k];
+          engine.computeKernelValues(scratch.point.data(), 0, svNumber, scratch.kernelValues.data() + (i - i0) * svNumber);
+        }
+        for (UnsignedInteger i = i0; i < i1; ++ i)
+        {
+          const double * kernelValues = scratch.kernelValues.data() + (i - i0) * svNumber;
+          UnsignedInteger p = 0;
+          for (UnsignedInteger c1 = 0; c1 < classNumber; ++ c1)
+            for (UnsignedInteger c2 = c1 + 1; c2 < classNumber; ++ c2)
+            {
+              const double * coefficient1 = model.sv_coef[c2 - 1];
+              const double * coefficient2 = model.sv_coef[c1];
+              double sum = 0.0;
+              for (SignedInteger k = 0; k < model.nSV[c1]; ++ k)
+                sum += coefficient1[start_[c1] + k] * kernelValues[start_[c1] + k];
+              for (SignedInteger k = 0; k < model.nSV[c2]; ++ k)
+                sum += coefficient2[start_[c2] + k] * kernelValues[start_[c2] + k];
+              scratch.decisionValues[p] = sum - model.rho[p];
+              ++ p;
+            }
+          AddVotes(scratch.decisionValues.data(), classNumber, votes_ + i * classNumber);
+        }
+      }
+    }
+  }
+}; /* end struct LibSVMVotePolicy */
+}
+
+void LibSVMImplementation::computeVotes(const Sample & sample, std::vector<UnsignedInteger> & votes) const
+{
+  const UnsignedInteger size = sample.getSize();
+  const UnsignedInteger dimension = sample.getDimension();
+  if (dimension != inputMean_.getDimension())
+    throw InvalidArgumentException(HERE) << "LibSVM: expected a sample of dimension " << inputMean_.getDimension() << ", got " << dimension;
+  const UnsignedInteger classNumber = p_model_->nr_class;
+  votes.assign(size * classNumber, 0);
+  if (size == 0)
+    return;
+  // first support vector of each class
+  std::vector<UnsignedInteger> start(classNumber, 0);
+  for (UnsignedInteger i = 1; i < classNumber; ++ i)
+    start[i] = start[i - 1] + p_model_->nSV[i - 1];
+  const UnsignedInteger blockNumber = (size + ClassificationBlockSize - 1) / ClassificationBlockSize;
+  const LibSVMVotePolicy policy(*this, sample, start, votes.data());
+  TBBImplementation::ParallelFor(0, blockNumber, policy);
+}
+
+Scalar LibSVMImplementation::predictPoint(const Point & x) const
+{
+  LibSVMScratch & scratch = GetScratch();
+  convertPoint(x, scratch.node);
+  const UnsignedInteger classNumber = p_model_->nr_class;
+  scratch.decisionValues.resize(std::max<UnsignedInteger>(1, classNumber * (classNumber - 1) / 2));
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+  scratch.workspace.resize(svm_predict_workspace_size(p_model_));
+  return svm_predict_values_workspace(p_model_, scratch.node.data(), scratch.decisionValues.data(), scratch.workspace.data());
+#else
+  return svm_predict_values(p_model_, scratch.node.data(), scratch.decisionValues.data());
+#endif
+}
+
+const svm_node * LibSVMImplementation::getTrainingNode(const UnsignedInteger k, std::vector<svm_node> & node) const
+{
+  if (parameter_.kernel_type == PRECOMPUTED)
+  {
+    // the kernel values of the point against the support vectors of the
+    // model, at their position, are gathered from the Gram matrix
+    const UnsignedInteger size = p_model_->l;
+    node.resize(size + 2);
+    node[0].index = 0;
+    node[0].value = 0.0;
+    for (UnsignedInteger j = 0; j < size; ++ j)
+    {
+      const UnsignedInteger serial = p_model_->sv_indices[j];
+      node[j + 1].index = j + 1;
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+      const UnsignedInteger trainingNumber = problem_.l;
+      node[j + 1].value = gramFloat_.size() ? gramFloat_[k * trainingNumber + serial - 1] : gramDouble_[k * trainingNumber + serial - 1];
+#else
+      node[j + 1].value = problem_.x[k][serial].value;
+#endif
+    }
+    node[size + 1].index = -1;
+    return node.data();
+  }
+  return problem_.x[k];
+}
+
 
 CLASSNAMEINIT(LibSVM)
 
@@ -90,6 +627,20 @@ LibSVM::LibSVM()
   p_implementation_->parameter_.shrinking = ResourceMap::GetAsUnsignedInteger( "LibSVM-Shrinking" );
 
   p_implementation_->parameter_.eps = ResourceMap::GetAsScalar("LibSVM-Epsilon");
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+  p_implementation_->parameter_.gram = nullptr;
+  p_implementation_->parameter_.gram_type = GRAM_DOUBLE;
+  p_implementation_->parameter_.gram_ld = 0;
+  p_implementation_->parameter_.cache_type = CACHE_FLOAT;
+  p_implementation_->parameter_.dense = nullptr;
+  p_implementation_->parameter_.dense_dim = 0;
+  p_implementation_->parameter_.dense_ld = 0;
+  p_implementation_->parameter_.nr_thread = 1;
+  p_implementation_->parameter_.warm_start = nullptr;
+  p_implementation_->parameter_.parallel_for = &LibSVMParallelFor;
+  p_implementation_->parameter_.solver_loops = SVMSolverVector::GetLoops();
+#endif
+  p_implementation_->threadNumber_ = ResourceMap::GetAsUnsignedInteger("LibSVM-NumberOfThreads");
   svm_set_print_string_function(&SVMLog);
 
   p_implementation_->problem_.x = 0;
@@ -130,46 +681,22 @@ void LibSVM::setModel(svm_model* model)
 
 SVMKernel LibSVM::getKernel() const
 {
-  switch(getKernelType())
-  {
-    case Polynomial:
-      return PolynomialKernel(getDegree(), getGamma(), getPolynomialConstant());
-      break;
-    case NormalRbf:
-      return NormalRBF(1.0 / (std::sqrt(2.0 * getGamma())));
-      break;
-    case Sigmoid:
-      return SigmoidKernel(getGamma(), getConstant());
-      break;
-    case Linear:
-      return LinearKernel();
-      break;
-    default:
-      throw InvalidArgumentException(HERE) << "LibSVM: unknown kernel type";
-  }
+  return p_implementation_->getKernel();
+}
+
+void LibSVM::setKernel(const SVMKernel & kernel)
+{
+  p_implementation_->parameter_.kernel_type = PRECOMPUTED;
+  p_implementation_->kernel_ = kernel;
+  p_implementation_->gramUpToDate_ = false;
 }
 
 /* Support vectors accessor */
 Sample LibSVM::getSupportVector(const UnsignedInteger dim)
 {
-  Sample res( getNumberSupportVector(), dim );
-
-
-  for ( UnsignedInteger l = 0 ; l < getNumberSupportVector() ; l++ )
-  {
-    Point node(dim);
-    UnsignedInteger j = 0;
-    svm_node* i = getNode(l);
-    while(i -> index != -1)
-    {
-      node[j] = i -> value;
-      ++ i;
-      j ++;
-    }
-    res[l] = node;
-  }
-
-  return res;
+  if (dim != p_implementation_->inputMean_.getDimension())
+    throw InvalidArgumentException(HERE) << "LibSVM: the support vectors are of dimension " << p_implementation_->inputMean_.getDimension();
+  return p_implementation_->getSupportVectorSample();
 }
 
 /* Constant accessor */
@@ -217,6 +744,8 @@ LibSVM::KernelType LibSVM::getKernelType() const
       return NormalRbf;
     case SIGMOID:
       return Sigmoid;
+    case PRECOMPUTED:
+      return Precomputed;
     default:
       throw InvalidArgumentException(HERE) << "LibSVM: kernel type not available.";
   }
@@ -246,6 +775,8 @@ void LibSVM::setKernelType(const UnsignedInteger kernelType)
       p_implementation_->parameter_.kernel_type = SIGMOID;
       break;
     }
+    case Precomputed:
+      throw InvalidArgumentException(HERE) << "LibSVM: the precomputed kernel type is set by setKernel.";
     default:
       throw InvalidArgumentException(HERE) << "LibSVM: kernel type not available.";
   }
@@ -257,6 +788,12 @@ svm_node* LibSVM::getNode(const UnsignedInteger index)
   return p_implementation_->p_model_ -> SV[index];
 }
 
+/* Number of threads accessor */
+void LibSVM::setNumberOfThreads(const UnsignedInteger threadNumber)
+{
+  p_implementation_->threadNumber_ = threadNumber;
+}
+
 /* SvmType accessor */
 void LibSVM::setSvmType(const UnsignedInteger svmType)
 {
@@ -277,14 +814,44 @@ void LibSVM::setSvmType(const UnsignedInteger svmType)
   }
 }
 
-/*kernelParameter accessor */
-void LibSVM::setKernelParameter(const Scalar kernelParameter)
+
+/* Gamma of libsvm from the kernel parameter of OpenTURNS */
+namespace
+{
+Scalar ComputeGamma(const Scalar kernelParameter)
 {
   if (fabs(kernelParameter) < 1e-25)
   {
     throw InvalidArgumentException(HERE) << "Kernel parameter too small: " << kernelParameter;
   }
-  p_implementation_->parameter_.gamma = 1.0 / (2.0 * kernelParameter * kernelParameter);
+  return 1.0 / (2.0 * kernelParameter * kernelParameter);
+}
+}
+
+/*kernelParameter accessor */
+void LibSVM::setKernelParameter(const Scalar kernelParameter)
+{
+  if (p_implementation_->parameter_.kernel_type == PRECOMPUTED)
+  {
+    // the kernel parameter is the first parameter of the kernel, if any
+    Point parameter;
+    try
+    {
+      parameter = p_implementation_->kernel_.getParameter();
+    }
+    catch (const NotYetImplementedException &)
+    {
+      return;
+    }
+    if (parameter.getSize() && (parameter[0] != kernelParameter))
+    {
+      parameter[0] = kernelParameter;
+      p_implementation_->kernel_.setParameter(parameter);
+      p_implementation_->gramUpToDate_ = false;
+    }
+    return;
+  }
+  p_implementation_->parameter_.gamma = ComputeGamma(kernelParameter);
 }
 
 /* Gamma accessor */
@@ -319,39 +886,562 @@ Scalar LibSVM::getOutput(const UnsignedInteger index)
 /* Perform train  */
 void LibSVM::performTrain()
 {
+  if (p_implementation_->parameter_.kernel_type == PRECOMPUTED)
+    p_implementation_->computeGram();
+  p_implementation_->setSolverThreads();
+  p_implementation_->setCacheSize(p_implementation_->parameter_, 1);
+  p_implementation_->freeModels();
   setModel(svm_train( &p_implementation_->problem_, &p_implementation_->parameter_ ));
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+  // the model predicts the points given by their kernel values, not their serial number
+  p_implementation_->p_model_->param.gram = nullptr;
+  // a single prediction is too short for a thread team, and may run in a parallel loop
+  p_implementation_->p_model_->param.nr_thread = 1;
+#endif
+  if (p_implementation_->parameter_.kernel_type == PRECOMPUTED)
+    p_implementation_->setPositionNodes(p_implementation_->p_model_);
+  p_implementation_->setSupportVectors();
 }
 
 
-Scalar LibSVM::runCrossValidation()
+/* Cross validation folds, shuffled by a generator of their own seeded from
+   the OpenTURNS one, which leaves the global C generator untouched and
+   makes the folds independent of the number of threads. As in libsvm, the
+   folds of a classification are stratified by class */
+void LibSVMImplementation::drawFolds(const UnsignedInteger nFolds, std::vector<UnsignedInteger> & perm, std::vector<UnsignedInteger> & foldStart) const
 {
-  UnsignedInteger size = p_implementation_->problem_.l;
-  Point target(size);
+  const UnsignedInteger size = problem_.l;
+  if (!nFolds)
+    throw InvalidArgumentException(HERE) << "LibSVM: the number of folds must be positive";
+  if (nFolds > size)
+    LOGWARN(OSS() << "LibSVM: " << nFolds << " folds for " << size << " points, leave-one-out cross validation instead");
+  const UnsignedInteger foldNumber = std::min(nFolds, size);
+  std::mt19937 generator(RandomGenerator::IntegerGenerate(std::numeric_limits<uint32_t>::max()));
+  perm.resize(size);
+  foldStart.resize(foldNumber + 1);
+  if ((parameter_.svm_type == C_SVC) && (foldNumber < size))
+  {
+    // group the points by class, in the order of their first occurrence
+    std::vector<double> label;
+    std::vector<std::vector<UnsignedInteger> > classIndices;
+    for (UnsignedInteger i = 0; i < size; ++ i)
+    {
+      const UnsignedInteger c = std::find(label.begin(), label.end(), problem_.y[i]) - label.begin();
+      if (c == label.size())
+      {
+        label.push_back(problem_.y[i]);
+        classIndices.push_back(std::vector<UnsignedInteger>());
+      }
+      classIndices[c].push_back(i);
+    }
+    for (UnsignedInteger c = 0; c < classIndices.size(); ++ c)
+    {
+      std::vector<UnsignedInteger> & index = classIndices[c];
+      for (UnsignedInteger i = 0; i < index.size(); ++ i)
+        std::swap(index[i], index[i + generator() % (index.size() - i)]);
+    }
+    // each fold takes its share of every class
+    UnsignedInteger k = 0;
+    for (UnsignedInteger i = 0; i < foldNumber; ++ i)
+    {
+      foldStart[i] = k;
+      for (UnsignedInteger c = 0; c < classIndices.size(); ++ c)
+      {
+        const UnsignedInteger count = classIndices[c].size();
+        for (UnsignedInteger j = i * count / foldNumber; j < (i + 1) * count / foldNumber; ++ j)
+          perm[k++] = classIndices[c][j];
+      }
+    }
+    foldStart[foldNumber] = k;
+  }
+  else
+  {
+    for (UnsignedInteger i = 0; i < size; ++ i)
+      perm[i] = i;
+    for (UnsignedInteger i = 0; i < size; ++ i)
+      std::swap(perm[i], perm[i + generator() % (size - i)]);
+    for (UnsignedInteger i = 0; i <= foldNumber; ++ i)
+      foldStart[i] = i * size / foldNumber;
+  }
+}
+
+/* Training of a range of (cell, output, fold) triples, each on its own copy
+   of the libsvm parameters. The predictions of the left-out points are
+   written in the target of the cell and output, the folds being disjoint.
+   Along a regularization path, a task is a (gamma, output, fold) triple whose
+   tradeoff factors are trained in increasing order, each from the model of
+   the previous one */
+namespace
+{
+struct LibSVMFoldPolicy
+{
+  const svm_problem & problem_;
+  const svm_parameter & parameter_;
+  const Point & tradeoffFactor_;
+  const Point & gamma_;
+  const std::vector<const double *> & outputs_;
+  const std::vector<UnsignedInteger> & perm_;
+  const std::vector<UnsignedInteger> & foldStart_;
+  const Indices & path_;
+  double * target_;
+
+  LibSVMFoldPolicy(const svm_problem & problem,
+                   const svm_parameter & parameter,
+                   const Point & tradeoffFactor,
+                   const Point & gamma,
+                   const std::vector<const double *> & outputs,
+                   const std::vector<UnsignedInteger> & perm,
+                   const std::vector<UnsignedInteger> & foldStart,
+                   const Indices & path,
+                   double * target)
+    : problem_(problem)
+    , parameter_(parameter)
+    , tradeoffFactor_(tradeoffFactor)
+    , gamma_(gamma)
+    , outputs_(outputs)
+    , perm_(perm)
+    , foldStart_(foldStart)
+    , path_(path)
+    , target_(target)
+  {
+    // Nothing to do
+  }
 
-  // launch validation
-  srand (1);
-  const UnsignedInteger nFolds = ResourceMap::GetAsUnsignedInteger("SVMRegression-NumberOfFolds");
-  svm_cross_validation(&p_implementation_->problem_, &p_implementation_->parameter_, nFolds, const_cast<double *>(target.data()));
+  /* Train the cell on the fold, the model being returned to the caller */
+  svm_model * trainFold(const UnsignedInteger cell,
+                        const UnsignedInteger output,
+                        const UnsignedInteger fold,
+                        const svm_problem & subproblem,
+                        const svm_model * warmStart) const
+  {
+    const UnsignedInteger tradeoffNumber = tradeoffFactor_.getSize();
+    svm_parameter parameter(parameter_);
+    parameter.C = tradeoffFactor_[cell % tradeoffNumber];
+    // no gamma for a precomputed kernel, which has its own Gram matrix
+    if (gamma_.getSize())
+      parameter.gamma = gamma_[cell / tradeoffNumber];
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+    parameter.warm_start = warmStart;
+#else
+    (void) warmStart;
+#endif
+    svm_model * model = svm_train(&subproblem, &parameter);
+    double * target = target_ + (cell * outputs_.size() + output) * problem_.l;
+    for (UnsignedInteger j = foldStart_[fold]; j < foldStart_[fold + 1]; ++ j)
+      target[perm_[j]] = svm_predict(model, problem_.x[perm_[j]]);
+    return model;
+  }
 
-  Scalar totalError = 0.0;
-  for (UnsignedInteger i = 0; i < size; ++ i)
+  inline void operator()(const TBBImplementation::BlockedRange<UnsignedInteger> & r) const
+  {
+    const UnsignedInteger size = problem_.l;
+    const UnsignedInteger foldNumber = foldStart_.size() - 1;
+    const UnsignedInteger tradeoffNumber = tradeoffFactor_.getSize();
+    std::vector<svm_node *> x;
+    std::vector<double> y;
+    const UnsignedInteger outputNumber = outputs_.size();
+    for (UnsignedInteger task = r.begin(); task != r.end(); ++ task)
+    {
+      const UnsignedInteger fold = task % foldNumber;
+      const UnsignedInteger output = (task / foldNumber) % outputNumber;
+      const UnsignedInteger group = task / (foldNumber * outputNumber);
+      const UnsignedInteger begin = foldStart_[fold];
+      const UnsignedInteger end = foldStart_[fold + 1];
+      x.clear();
+      y.clear();
+      for (UnsignedInteger j = 0; j < size; ++ j)
+        if ((j < begin) || (j >= end))
+        {
+          x.push_back(problem_.x[perm_[j]]);
+          y.push_back(outputs_[output][perm_[j]]);
+        }
+      svm_problem subproblem;
+      subproblem.l = x.size();
+      subproblem.x = x.data();
+      subproblem.y = y.data();
+      if (path_.getSize())
+      {
+        svm_model * model = nullptr;
+        for (UnsignedInteger k = 0; k < tradeoffNumber; ++ k)
+        {
+          svm_model * next = trainFold(group * tradeoffNumber + path_[k], output, fold, subproblem, model);
+          if (model)
+            svm_free_and_destroy_model(&model);
+          model = next;
+        }
+        svm_free_and_destroy_model(&model);
+      }
+      else
+      {
+        svm_model * model = trainFold(group, output, fold, subproblem, nullptr);
+        svm_free_and_destroy_model(&model);
+      }
+    }
+  }
+}; /* end struct LibSVMFoldPolicy */
+}
+
+/* The cells, outputs and folds are all trained concurrently, or the (gamma,
+   output, fold) triples along the path of increasing tradeoff factors */
+void LibSVMImplementation::runFolds(const svm_parameter & parameter,
+                                    const Point & tradeoffFactor,
+                                    const Point & gamma,
+                                    const std::vector<const double *> & outputs,
+                                    const std::vector<UnsignedInteger> & perm,
+                                    const std::vector<UnsignedInteger> & foldStart,
+                                    const Indices & path,
+                                    Scalar * error) const
+{
+  const UnsignedInteger size = problem_.l;
+  const UnsignedInteger outputNumber = outputs.size();
+  const UnsignedInteger cellNumber = tradeoffFactor.getSize() * std::max<UnsignedInteger>(1, gamma.getSize());
+  const UnsignedInteger taskNumber = (path.getSize() ? cellNumber / tradeoffFactor.getSize() : cellNumber) * outputNumber * (foldStart.size() - 1);
+  std::vector<double> target(cellNumber * outputNumber * size);
+  const LibSVMFoldPolicy policy(problem_, parameter, tradeoffFactor, gamma, outputs, perm, foldStart, path, target.data());
+  TBBImplementation::ParallelFor(0, taskNumber, policy);
+  for (UnsignedInteger k = 0; k < cellNumber * outputNumber; ++ k)
+  {
+    const double * y = outputs[k % outputNumber];
+    Scalar totalError = 0.0;
+    for (UnsignedInteger i = 0; i < size; ++ i)
+      totalError += (y[i] - target[k * size + i]) * (y[i] - target[k * size + i]) / size;
+    error[k] = totalError;
+  }
+}
+
+/* Without a shared cache, each training rebuilds the kernel columns it needs.
+   With the dense data of the bundled libsvm, the nodes are serial numbers:
+   the Gram matrix of a gamma, computed once, then serves as a read-only
+   kernel cache for all the tradeoff factors, outputs and folds of this gamma,
+   and is released before the next gamma. When its double values do not fit
+   in LibSVM-GridCacheSize, it is shared in single precision, as the columns
+   of the solver caches are */
+void LibSVMImplementation::crossValidate(const Point & tradeoffFactor,
+    const Point & gamma,
+    const std::vector<const double *> & outputs,
+    const std::vector<UnsignedInteger> & perm,
+    const std::vector<UnsignedInteger> & foldStart,
+    Scalar * error)
+{
+  if (parameter_.kernel_type == PRECOMPUTED)
+    computeGram();
+  svm_parameter parameter(parameter_);
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+  const UnsignedInteger size = problem_.l;
+  const UnsignedInteger tradeoffNumber = tradeoffFactor.getSize();
+  const UnsignedInteger gammaNumber = std::max<UnsignedInteger>(1, gamma.getSize());
+  const UnsignedInteger foldNumber = foldStart.size() - 1;
+  const UnsignedInteger outputNumber = outputs.size();
+  // order of the tradeoff factors along the regularization path, if any
+  Indices path;
+  if (ResourceMap::GetAsBool("LibSVM-RegularizationPath") && (tradeoffNumber > 1)
+      && ((parameter_.svm_type == C_SVC) || (parameter_.svm_type == EPSILON_SVR)))
+  {
+    std::vector<std::pair<Scalar, UnsignedInteger> > order(tradeoffNumber);
+    for (UnsignedInteger k = 0; k < tradeoffNumber; ++ k)
+      order[k] = std::make_pair(tradeoffFactor[k], k);
+    std::sort(order.begin(), order.end());
+    path = Indices(tradeoffNumber);
+    for (UnsignedInteger k = 0; k < tradeoffNumber; ++ k)
+      path[k] = order[k].second;
+  }
+  const UnsignedInteger pathNumber = path.getSize() ? 1 : tradeoffNumber;
+  // the threads of the solver are shared among the trainings
+  setSolverThreads();
+  // the shared Gram matrix holds the double values the solver would compute,
+  // so that the cross validation does not depend on it, unless only its
+  // single precision values fit
+  const UnsignedInteger gridCacheSize = ResourceMap::GetAsUnsignedInteger("LibSVM-GridCacheSize") * 1024 * 1024;
+  const Bool shareable = parameter_.dense && (parameter_.kernel_type != PRECOMPUTED) && (tradeoffNumber * outputNumber > 1);
+  const Bool shareGram = shareable && (size * size * sizeof(float) <= gridCacheSize);
+  const Bool doubleGram = shareGram && (size * size * sizeof(double) <= gridCacheSize);
+  if (shareable && !doubleGram)
+    LOGINFO(OSS() << "LibSVM: the Gram matrix of " << size << " points does not fit in LibSVM-GridCacheSize in double precision, "
+            << (shareGram ? "the cells share it in single precision" : "the cells compute their own kernel values"));
+  if (shareGram)
+  {
+    if (doubleGram)
+    {
+      gramFloat_.clear();
+      gramDouble_.resize(size * size);
+    }
+    else
+    {
+      gramDouble_.clear();
+      gramFloat_.resize(size * size);
+    }
+    parameter.nr_thread = std::max<int>(1, parameter_.nr_thread / (pathNumber * outputNumber * foldNumber));
+    for (UnsignedInteger gammaIndex = 0; gammaIndex < gammaNumber; ++ gammaIndex)
+    {
+      if (gamma.getSize())
+        parameter.gamma = gamma[gammaIndex];
+      svm_parameter gramParameter(parameter);
+      gramParameter.nr_thread = parameter_.nr_thread;
+      if (doubleGram)
+      {
+        svm_compute_gram(&problem_, &gramParameter, gramDouble_.data());
+        gramParameter.gram = gramDouble_.data();
+        gramParameter.gram_type = GRAM_DOUBLE;
+      }
+      else
+      {
+        svm_compute_gram_float(&problem_, &gramParameter, gramFloat_.data());
+        gramParameter.gram = gramFloat_.data();
+        gramParameter.gram_type = GRAM_FLOAT;
+      }
+      gramParameter.nr_thread = parameter.nr_thread;
+      gramParameter.gram_ld = size;
+      gramParameter.kernel_type = PRECOMPUTED;
+      setCacheSize(gramParameter, pathNumber * outputNumber * foldNumber);
+      runFolds(gramParameter, tradeoffFactor, Point(), outputs, perm, foldStart, path, error + gammaIndex * tradeoffNumber * outputNumber);
+    }
+    gramDouble_ = std::vector<double>();
+    gramFloat_ = std::vector<float>();
+    return;
+  }
+  parameter.nr_thread = std::max<int>(1, parameter_.nr_thread / (pathNumber * gammaNumber * outputNumber * foldNumber));
+  setCacheSize(parameter, pathNumber * gammaNumber * outputNumber * foldNumber);
+  runFolds(parameter, tradeoffFactor, gamma, outputs, perm, foldStart, path, error);
+#else
+  setCacheSize(parameter, tradeoffFactor.getSize() * std::max<UnsignedInteger>(1, gamma.getSize()) * outputs.size() * (foldStart.size() - 1));
+  runFolds(parameter, tradeoffFactor, gamma, outputs, perm, foldStart, Indices(), error);
+#endif
+}
+
+/* Training of a range of outputs, each on its own copy of the libsvm
+   parameters and with its own values */
+namespace
+{
+struct LibSVMOutputPolicy
+{
+  const svm_problem & problem_;
+  const svm_parameter & parameter_;
+  const Point & tradeoffFactor_;
+  const Point & gamma_;
+  const double * outputs_;
+  const Indices & outputIndices_;
+  std::vector<svm_model *> & models_;
+
+  LibSVMOutputPolicy(const svm_problem & problem,
+                     const svm_parameter & parameter,
+                     const Point & tradeoffFactor,
+                     const Point & gamma,
+                     const double * outputs,
+                     const Indices & outputIndices,
+                     std::vector<svm_model *> & models)
+    : problem_(problem)
+    , parameter_(parameter)
+    , tradeoffFactor_(tradeoffFactor)
+    , gamma_(gamma)
+    , outputs_(outputs)
+    , outputIndices_(outputIndices)
+    , models_(models)
+  {
+    // Nothing to do
+  }
+
+  inline void operator()(const TBBImplementation::BlockedRange<UnsignedInteger> & r) const
+  {
+    for (UnsignedInteger k = r.begin(); k != r.end(); ++ k)
+    {
+      const UnsignedInteger output = outputIndices_[k];
+      svm_parameter parameter(parameter_);
+      parameter.C = tradeoffFactor_[output];
+      // no gamma for a precomputed kernel, which has its own Gram matrix
+      if (gamma_.getSize())
+        parameter.gamma = gamma_[output];
+      svm_problem problem(problem_);
+      problem.y = const_cast<double *>(outputs_ + output * problem_.l);
+      svm_model * model = svm_train(&problem, &parameter);
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+      model->param.gram = nullptr;
+      model->param.nr_thread = 1;
+#endif
+      models_[output] = model;
+    }
+  }
+}; /* end struct LibSVMOutputPolicy */
+}
+
+/* The outputs share the converted input points and are trained concurrently,
+   those of a precomputed kernel sharing the Gram matrix of their kernel
+   parameter. With the dense data of the bundled libsvm, the outputs of a
+   kernel parameter also share its Gram matrix when it fits in
+   LibSVM-GridCacheSize, as the cells of crossValidate do: it holds the
+   values the solver would compute, so the models do not depend on it.
+   The model of the first output is selected */
+void LibSVM::performTrain(const Point & tradeoffFactor, const Point & kernelParameter)
+{
+  LibSVMImplementation & implementation = *p_implementation_;
+  const UnsignedInteger outputNumber = implementation.outputNumber_;
+  if ((tradeoffFactor.getSize() != outputNumber) || (kernelParameter.getSize() != outputNumber))
+    throw InvalidArgumentException(HERE) << "LibSVM: expected " << outputNumber << " tradeoff factors and kernel parameters, got " << tradeoffFactor.getSize() << " and " << kernelParameter.getSize();
+  implementation.freeModels();
+  implementation.models_.assign(outputNumber, nullptr);
+  implementation.outputKernelParameter_ = kernelParameter;
+  implementation.setSolverThreads();
+  if (implementation.parameter_.kernel_type == PRECOMPUTED)
+  {
+    std::vector<Bool> done(outputNumber, false);
+    for (UnsignedInteger j = 0; j < outputNumber; ++ j)
+    {
+      if (done[j])
+        continue;
+      Indices outputIndices;
+      for (UnsignedInteger k = j; k < outputNumber; ++ k)
+        if (kernelParameter[k] == kernelParameter[j])
+        {
+          outputIndices.add(k);
+          done[k] = true;
+        }
+      setKernelParameter(kernelParameter[j]);
+      implementation.computeGram();
+      svm_parameter parameter(implementation.parameter_);
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+      parameter.nr_thread = std::max<int>(1, parameter.nr_thread / outputIndices.getSize());
+#endif
+      implementation.setCacheSize(parameter, outputIndices.getSize());
+      const LibSVMOutputPolicy policy(implementation.problem_, parameter, tradeoffFactor, Point(), implementation.outputs_.data(), outputIndices, implementation.models_);
+      TBBImplementation::ParallelFor(0, outputIndices.getSize(), policy);
+    }
+    for (UnsignedInteger j = 0; j < outputNumber; ++ j)
+      implementation.setPositionNodes(implementation.models_[j]);
+  }
+  else
+  {
+    Point gamma(outputNumber);
+    for (UnsignedInteger j = 0; j < outputNumber; ++ j)
+      gamma[j] = ComputeGamma(kernelParameter[j]);
+    std::vector<Bool> done(outputNumber, false);
+    for (UnsignedInteger j = 0; j < outputNumber; ++ j)
+    {
+      if (done[j])
+        continue;
+      Indices outputIndices;
+      for (UnsignedInteger k = j; k < outputNumber; ++ k)
+        if (kernelParameter[k] == kernelParameter[j])
+        {
+          outputIndices.add(k);
+          done[k] = true;
+        }
+      svm_parameter parameter(implementation.parameter_);
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+      parameter.nr_thread = std::max<int>(1, parameter.nr_thread / outputIndices.getSize());
+      const UnsignedInteger size = implementation.problem_.l;
+      const Bool shareGram = implementation.parameter_.dense && (outputIndices.getSize() > 1)
+                             && (size * size * sizeof(double) <= ResourceMap::GetAsUnsignedInteger("LibSVM-GridCacheSize") * 1024 * 1024);
+      if (shareGram)
+      {
+        implementation.gramFloat_.clear();
+        implementation.gramDouble_.resize(size * size);
+        svm_parameter gramParameter(implementation.parameter_);
+        gramParameter.gamma = gamma[j];
+        svm_compute_gram(&implementation.problem_, &gramParameter, implementation.gramDouble_.data());
+        parameter.gram = implementation.gramDouble_.data();
+        parameter.gram_type = GRAM_DOUBLE;
+        parameter.gram_ld = size;
+        parameter.kernel_type = PRECOMPUTED;
+      }
+#endif
+      implementation.setCacheSize(parameter, outputIndices.getSize());
+      const LibSVMOutputPolicy policy(implementation.problem_, parameter, tradeoffFactor, gamma, implementation.outputs_.data(), outputIndices, implementation.models_);
+      TBBImplementation::ParallelFor(0, outputIndices.getSize(), policy);
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+      // the models predict the points through their own kernel
+      if (shareGram)
+        for (UnsignedInteger k = 0; k < outputIndices.getSize(); ++ k)
+          implementation.models_[outputIndices[k]]->param.kernel_type = implementation.parameter_.kernel_type;
+#endif
+    }
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+    implementation.gramDouble_ = std::vector<double>();
+#endif
+  }
+  selectOutput(0);
+}
+
+/* The parameters and the problem follow the selected model */
+void LibSVM::selectOutput(const UnsignedInteger index)
+{
+  LibSVMImplementation & implementation = *p_implementation_;
+  if (index >= implementation.models_.size())
+    throw InvalidArgumentException(HERE) << "LibSVM: output index " << index << " must be less than " << implementation.models_.size();
+  implementation.p_model_ = implementation.models_[index];
+  implementation.parameter_.C = implementation.p_model_->param.C;
+  if (implementation.parameter_.kernel_type == PRECOMPUTED)
   {
-    totalError += (p_implementation_->problem_.y[i] - target[i]) * (p_implementation_->problem_.y[i] - target[i]) / size;
+    // the training nodes of computeError and computeAccuracy follow the Gram
+    // matrix of the selected kernel parameter
+    setKernelParameter(implementation.outputKernelParameter_[index]);
+    implementation.computeGram();
   }
+  else
+    implementation.parameter_.gamma = implementation.p_model_->param.gamma;
+  const UnsignedInteger size = implementation.problem_.l;
+  std::copy(implementation.outputs_.begin() + index * size, implementation.outputs_.begin() + (index + 1) * size, implementation.problem_.y);
+  implementation.setSupportVectors();
+}
+
+
+Scalar LibSVM::runCrossValidation()
+{
+  std::vector<UnsignedInteger> perm;
+  std::vector<UnsignedInteger> foldStart;
+  p_implementation_->drawFolds(ResourceMap::GetAsUnsignedInteger("SVMRegression-NumberOfFolds"), perm, foldStart);
+  Scalar totalError = 0.0;
+  const std::vector<const double *> outputs(1, p_implementation_->problem_.y);
+  p_implementation_->crossValidate(Point(1, p_implementation_->parameter_.C), Point(), outputs, perm, foldStart, &totalError);
 
   LOGDEBUG(OSS() << "LibSVM::runCrossValidation gamma=" << p_implementation_->parameter_.gamma << " C=" << p_implementation_->parameter_.C << " err=" << totalError);
 
   return totalError;
 }
 
+/* The errors are given for the kernel parameters in the outer loop and the
+   tradeoff factors in the inner loop, one column per output. All the cells
+   share the same folds, and their errors do not depend on the scheduling */
+Sample LibSVM::runCrossValidation(const Point & tradeoffFactor, const Point & kernelParameter)
+{
+  const UnsignedInteger tradeoffNumber = tradeoffFactor.getSize();
+  const UnsignedInteger kernelParameterNumber = kernelParameter.getSize();
+  const UnsignedInteger outputNumber = p_implementation_->outputNumber_;
+  Sample error(tradeoffNumber * kernelParameterNumber, outputNumber);
+  if (!error.getSize() || !outputNumber)
+    return error;
+  std::vector<const double *> outputs(outputNumber);
+  for (UnsignedInteger j = 0; j < outputNumber; ++ j)
+    outputs[j] = p_implementation_->outputs_.data() + j * p_implementation_->problem_.l;
+  std::vector<UnsignedInteger> perm;
+  std::vector<UnsignedInteger> foldStart;
+  p_implementation_->drawFolds(ResourceMap::GetAsUnsignedInteger("SVMRegression-NumberOfFolds"), perm, foldStart);
+  if (p_implementation_->parameter_.kernel_type == PRECOMPUTED)
+  {
+    // the cells of a kernel parameter share its Gram matrix
+    for (UnsignedInteger kernelParameterIndex = 0; kernelParameterIndex < kernelParameterNumber; ++ kernelParameterIndex)
+    {
+      setKernelParameter(kernelParameter[kernelParameterIndex]);
+      p_implementation_->crossValidate(tradeoffFactor, Point(), outputs, perm, foldStart, &error(kernelParameterIndex * tradeoffNumber, 0));
+    }
+  }
+  else
+  {
+    Point gamma(kernelParameterNumber);
+    for (UnsignedInteger kernelParameterIndex = 0; kernelParameterIndex < kernelParameterNumber; ++ kernelParameterIndex)
+      gamma[kernelParameterIndex] = ComputeGamma(kernelParameter[kernelParameterIndex]);
+    p_implementation_->crossValidate(tradeoffFactor, gamma, outputs, perm, foldStart, &error(0, 0));
+  }
+  return error;
+}
+
 
 Scalar LibSVM::computeError()
 {
   Scalar totalerror = 0;
 
+  std::vector<svm_node> node;
   for ( UnsignedInteger k = 0 ; k < (UnsignedInteger)p_implementation_->problem_.l ; k++ )
   {
-    const Scalar slack = p_implementation_->problem_.y[k] - svm_predict(p_implementation_->p_model_, p_implementation_->problem_.x[k]);
+    const Scalar slack = p_implementation_->problem_.y[k] - svm_predict(p_implementation_->p_model_, p_implementation_->getTrainingNode(k, node));
     totalerror += slack * slack;
   }
   totalerror = std::sqrt(totalerror) / p_implementation_->problem_.l;
@@ -362,8 +1452,9 @@ Scalar LibSVM::computeError()
 Scalar LibSVM::computeAccuracy()
 {
   UnsignedInteger totalerror = 0;
+  std::vector<svm_node> node;
   for (UnsignedInteger k = 0 ; k < (UnsignedInteger)p_implementation_->problem_.l ; ++ k)
-    if (p_implementation_->problem_.y[k] != svm_predict(p_implementation_->p_model_, p_implementation_->problem_.x[k]))
+    if (p_implementation_->problem_.y[k] != svm_predict(p_implementation_->p_model_, p_implementation_->getTrainingNode(k, node)))
       ++ totalerror;
   return totalerror;
 }
@@ -374,27 +1465,98 @@ template <typename T> T * LibSVM::Allocation(const UnsignedInteger size) const
 }
 
 
-/* normalize the sample */
-void LibSVM::normalize(const Sample &data, Function & transformation, Function & inverseTransformation) const
+namespace
+{
+/* Mean and scale factor of each component, the components of zero
+   deviation being only centered */
+void ComputeScaling(const Sample & data, Point & mean, Point & scale, Point & inverseScale)
+{
+  const UnsignedInteger dimension = data.getDimension();
+  mean = data.computeMean();
+  const Point stdev(data.computeStandardDeviation());
+  scale = Point(dimension, 1.0);
+  inverseScale = Point(dimension, 1.0);
+  for (UnsignedInteger j = 0; j < dimension; ++ j)
+    if (fabs(stdev[j]) > SpecFunc::MinScalar)
+    {
+      scale[j] /= stdev[j];
+      inverseScale[j] *= stdev[j];
+    }
+}
+
+/* Affine function x -> diag(scale) (x - center) + constant */
+LinearFunction ScalingFunction(const Point & center, const Point & constant, const Point & scale)
 {
-  UnsignedInteger dimension = data.getDimension();
-  Point mean(data.computeMean());
-  Point stdev(data.computeStandardDeviation());
+  const UnsignedInteger dimension = scale.getDimension();
   SquareMatrix linear(dimension);
-  SquareMatrix linearInv(dimension);
   for (UnsignedInteger j = 0; j < dimension; ++ j)
+    linear(j, j) = scale[j];
+  return LinearFunction(center, constant, linear);
+}
+
+/* Normalization of a range of rows, written in the node rows of the
+   sparse libsvm format or in a row-major array */
+struct LibSVMNormalizationPolicy
+{
+  const Sample & input_;
+  const Point & mean_;
+  const Point & scale_;
+  svm_node * nodes_;
+  Scalar * values_;
+
+  LibSVMNormalizationPolicy(const Sample & input,
+                            const Point & mean,
+                            const Point & scale,
+                            svm_node * nodes,
+                            Scalar * values)
+    : input_(input)
+    , mean_(mean)
+    , scale_(scale)
+    , nodes_(nodes)
+    , values_(values)
   {
-    linearInv(j, j) = 1.0;
-    linear(j, j) = 1.0;
-    if (fabs(stdev[j]) > SpecFunc::MinScalar)
+    // Nothing to do
+  }
+
+  inline void operator()(const TBBImplementation::BlockedRange<UnsignedInteger> & r) const
+  {
+    const UnsignedInteger dimension = input_.getDimension();
+    const Scalar * mean = mean_.data();
+    const Scalar * scale = scale_.data();
+    for (UnsignedInteger j = r.begin(); j != r.end(); ++ j)
     {
-      linear(j, j) /= stdev[j];
-      linearInv(j, j) *= stdev[j];
+      const Scalar * x = &input_(j, 0);
+      if (nodes_)
+      {
+        svm_node * row = nodes_ + j * (dimension + 1);
+        for (UnsignedInteger i = 0; i < dimension; ++ i)
+        {
+          row[i].index = i + 1;
+          row[i].value = (x[i] - mean[i]) * scale[i];
+        }
+        row[dimension].index = -1;
+      }
+      else
+      {
+        Scalar * row = values_ + j * dimension;
+        for (UnsignedInteger i = 0; i < dimension; ++ i)
+          row[i] = (x[i] - mean[i]) * scale[i];
+      }
     }
   }
-  Point zero(dimension);
-  transformation = LinearFunction(mean, zero, linear);
-  inverseTransformation = LinearFunction(zero, mean, linearInv);
+}; /* end struct LibSVMNormalizationPolicy */
+}
+
+/* normalize the sample */
+void LibSVM::normalize(const Sample &data, Function & transformation, Function & inverseTransformation) const
+{
+  Point mean;
+  Point scale;
+  Point inverseScale;
+  ComputeScaling(data, mean, scale, inverseScale);
+  const Point zero(data.getDimension());
+  transformation = ScalingFunction(mean, zero, scale);
+  inverseTransformation = ScalingFunction(zero, mean, inverseScale);
 }
 
 
@@ -411,24 +1573,103 @@ void LibSVM::convertData(const Sample & inputSample, const Sample & outputSample
   const UnsignedInteger size = inputSample.getSize();
   const UnsignedInteger inputDimension = inputSample.getDimension();
 
-  Function inputInverseTransformation;
-  normalize(inputSample, inputTransformation_, inputInverseTransformation);
-
-  // write in/out into problem data
+  // the scaling is applied to the whole sample at once rather than through
+  // the evaluation of the transformation on each point
+  Point mean;
+  Point scale;
+  Point inverseScale;
+  ComputeScaling(inputSample, mean, scale, inverseScale);
+  inputTransformation_ = ScalingFunction(mean, Point(inputDimension), scale);
+  p_implementation_->inputMean_ = mean;
+  p_implementation_->inputScale_ = scale;
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+  p_implementation_->parameter_.dense = nullptr;
+#endif
+
+  // write in/out into problem data, the problem holding the first output
+  const UnsignedInteger outputDimension = outputSample.getDimension();
+  p_implementation_->outputNumber_ = outputDimension;
+  p_implementation_->outputs_.resize(size * outputDimension);
+  for (UnsignedInteger k = 0; k < outputDimension; ++ k)
+    for (UnsignedInteger j = 0; j < size; ++ j)
+      p_implementation_->outputs_[k * size + j] = outputSample(j, k);
   p_implementation_->problem_.l = size;
   p_implementation_->problem_.y = Allocation<double>(size);
   p_implementation_->problem_.x = Allocation<struct svm_node *>(size);
-  p_implementation_->p_node_ = Allocation<struct svm_node>(size * (inputDimension + 1));
-  for (UnsignedInteger j = 0; j < size; ++ j)
+  std::copy(p_implementation_->outputs_.begin(), p_implementation_->outputs_.begin() + size, p_implementation_->problem_.y);
+  if (p_implementation_->parameter_.kernel_type == PRECOMPUTED)
   {
-    p_implementation_->problem_.x[j] = & p_implementation_->p_node_[j * (inputDimension + 1)];
-    p_implementation_->problem_.y[j] = outputSample[j][0];
-    for (UnsignedInteger i = 0; i < inputDimension; ++i)
+    Sample normalizedInput(size, inputDimension);
+    if (size && inputDimension)
+    {
+      const LibSVMNormalizationPolicy policy(inputSample, mean, scale, nullptr, &normalizedInput(0, 0));
+      TBBImplementation::ParallelFor(0, size, policy);
+    }
+    p_implementation_->normalizedInput_ = normalizedInput;
+    p_implementation_->gramUpToDate_ = false;
+
+    // the nodes give the serial number of the points, followed by their
+    // kernel values without the dense Gram matrix of the bundled libsvm
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+    const UnsignedInteger rowSize = 2;
+#else
+    const UnsignedInteger rowSize = size + 2;
+#endif
+    p_implementation_->p_node_ = Allocation<struct svm_node>(size * rowSize);
+    for (UnsignedInteger j = 0; j < size; ++ j)
+    {
+      svm_node * row = & p_implementation_->p_node_[j * rowSize];
+      p_implementation_->problem_.x[j] = row;
+      row[0].index = 0;
+      row[0].value = j + 1;
+      for (UnsignedInteger i = 1; i < rowSize - 1; ++ i)
+        row[i].index = i;
+      row[rowSize - 1].index = -1;
+    }
+    // a model has at most one support vector per training point
+    p_implementation_->positionNodes_.resize(2 * size);
+    for (UnsignedInteger k = 0; k < size; ++ k)
+    {
+      p_implementation_->positionNodes_[2 * k].index = 0;
+      p_implementation_->positionNodes_[2 * k].value = k + 1;
+      p_implementation_->positionNodes_[2 * k + 1].index = -1;
+      p_implementation_->positionNodes_[2 * k + 1].value = 0.0;
+    }
+    return;
+  }
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+  if (ResourceMap::GetAsBool("LibSVM-UseDenseData"))
+  {
+    // contiguous rows read by the bundled libsvm through the serial number
+    // held by the nodes, instead of index/value pairs
+    p_implementation_->denseInput_.resize(size * inputDimension);
+    if (size && inputDimension)
+    {
+      const LibSVMNormalizationPolicy policy(inputSample, mean, scale, nullptr, p_implementation_->denseInput_.data());
+      TBBImplementation::ParallelFor(0, size, policy);
+    }
+    p_implementation_->p_node_ = Allocation<struct svm_node>(size * 2);
+    for (UnsignedInteger j = 0; j < size; ++ j)
     {
-      p_implementation_->p_node_[j * (inputDimension + 1) + i].index = i + 1;
-      p_implementation_->p_node_[j * (inputDimension + 1) + i].value = inputTransformation_(inputSample[j])[i];
+      svm_node * row = & p_implementation_->p_node_[j * 2];
+      p_implementation_->problem_.x[j] = row;
+      row[0].index = 0;
+      row[0].value = j + 1;
+      row[1].index = -1;
     }
-    p_implementation_->p_node_[j * (inputDimension + 1) + inputDimension].index = - 1;
+    p_implementation_->parameter_.dense = p_implementation_->denseInput_.data();
+    p_implementation_->parameter_.dense_dim = inputDimension;
+    p_implementation_->parameter_.dense_ld = inputDimension;
+    return;
+  }
+#endif
+  p_implementation_->p_node_ = Allocation<struct svm_node>(size * (inputDimension + 1));
+  for (UnsignedInteger j = 0; j < size; ++ j)
+    p_implementation_->problem_.x[j] = & p_implementation_->p_node_[j * (inputDimension + 1)];
+  if (size)
+  {
+    const LibSVMNormalizationPolicy policy(inputSample, mean, scale, p_implementation_->p_node_, nullptr);
+    TBBImplementation::ParallelFor(0, size, policy);
   }
 }
 
@@ -444,10 +1685,18 @@ void LibSVM::destroy()
     free(p_implementation_->problem_.y);
     p_implementation_->problem_.y = 0;
   }
+  // release the memory of the Gram matrix
+  p_implementation_->gramDouble_ = std::vector<double>();
+  p_implementation_->gramFloat_ = std::vector<float>();
+  p_implementation_->gramUpToDate_ = false;
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+  p_implementation_->parameter_.gram = nullptr;
+#endif
 }
 
 void LibSVM::destroyModel()
 {
+  p_implementation_->freeModels();
   if (p_implementation_->p_model_)
   {
     svm_free_model_content(p_implementation_->p_model_);
@@ -458,135 +1707,89 @@ void LibSVM::destroyModel()
     free(p_implementation_->p_node_);
     p_implementation_->p_node_ = 0;
   }
+  p_implementation_->denseInput_ = std::vector<double>();
+  p_implementation_->outputs_ = std::vector<double>();
+  p_implementation_->outputNumber_ = 0;
+#ifdef LIBSVM_OTSVM_EXTENSIONS
+  p_implementation_->parameter_.dense = nullptr;
+#endif
 }
 
 UnsignedInteger LibSVM::getLabel(const Point & vector) const
 {
-  const UnsignedInteger size = vector.getSize();
-  svm_problem prob;
-  svm_node* node;
-
-  prob.x = Allocation<struct svm_node *>(1);
-  node = Allocation<struct svm_node>(size + 1);
-
-  prob.x[0] = & node[0];
-  for(UnsignedInteger j = 0; j < size; j++)
-  {
-    node[j].index = j + 1;
-    node[j].value = inputTransformation_(vector)[j];
-  }
-  node[size].index = -1;
-
-  UnsignedInteger res = svm_predict(p_implementation_->p_model_, prob.x[0]);
-
-  free(prob.x);
-  free(node);
-
-  return res;
-
+  return p_implementation_->predictPoint(vector);
 }
 
 UnsignedInteger LibSVM::getLabelValues(const Point & vector, const SignedInteger outC) const
 {
-  const UnsignedInteger size = vector.getSize();
-  svm_problem prob;
-  svm_node* node;
-
-  prob.x = Allocation<struct svm_node *>(1);
-  node = Allocation<struct svm_node>(size + 1);
-
-  prob.x[0] = & node[0];
-  for(UnsignedInteger j = 0; j < size; j++)
-  {
-    node[j].index = j + 1;
-    node[j].value = inputTransformation_(vector)[j];
-  }
-  node[size].index = -1;
+  p_implementation_->predictPoint(vector);
+  LibSVMScratch & scratch = GetScratch();
+  const double * dec_values = scratch.decisionValues.data();
 
   const UnsignedInteger numberclass = svm_get_nr_class(p_implementation_->p_model_);
-  double *dec_values = Allocation < double > ( numberclass * ( numberclass - 1 ) / 2);
-  Point vote(numberclass);
-  UnsignedInteger pos = 0;
-
-  svm_predict_values(p_implementation_->p_model_, prob.x[0], dec_values);
-
-  for (UnsignedInteger i = 0; i < numberclass; ++ i)
-  {
-    for(UnsignedInteger j = i + 1; j < numberclass; ++ j)
-    {
-      if(dec_values[pos++] > 0)
-        ++ vote[i];
-      else
-        ++ vote[j];
-    }
-  }
+  std::vector<UnsignedInteger> & vote = scratch.votes;
+  vote.assign(numberclass, 0);
+  AddVotes(dec_values, numberclass, vote.data());
 
   UnsignedInteger res = 0;
   for (UnsignedInteger i = 0; i < numberclass; ++ i)
     if((SignedInteger)p_implementation_->p_model_->label[i] == outC)
       res = i;
 
-  free(dec_values);
   return vote[res];
 }
 
 
-Scalar LibSVM::predict(const Point & inP) const
+Indices LibSVM::getLabel(const Sample & sample) const
 {
-  UnsignedInteger inputDimension = inP.getDimension();
-  struct svm_node *x = Allocation<struct svm_node>(inputDimension + 1);
-  for (UnsignedInteger i = 0; i < inputDimension; ++ i)
+  std::vector<UnsignedInteger> votes;
+  p_implementation_->computeVotes(sample, votes);
+  const UnsignedInteger size = sample.getSize();
+  const UnsignedInteger classNumber = p_implementation_->p_model_->nr_class;
+  Indices result(size);
+  for (UnsignedInteger i = 0; i < size; ++ i)
   {
-    x[i].index = i + 1;
-    x[i].value = inputTransformation_(inP)[i];
+    const UnsignedInteger * vote = &votes[i * classNumber];
+    // first class of maximal vote, as svm_predict
+    UnsignedInteger voteMaxIndex = 0;
+    for (UnsignedInteger j = 1; j < classNumber; ++ j)
+      if (vote[j] > vote[voteMaxIndex])
+        voteMaxIndex = j;
+    result[i] = p_implementation_->p_model_->label[voteMaxIndex];
   }
-  x[inputDimension].index = -1;
+  return result;
+}
 
-  double res = 0.0;
-  if (svm_get_svm_type(p_implementation_->p_model_) == ONE_CLASS ||
-      svm_get_svm_type(p_implementation_->p_model_) == EPSILON_SVR ||
-      svm_get_svm_type(p_implementation_->p_model_) == NU_SVR)
+Point LibSVM::getLabelValues(const Sample & sample, const Indices & outC) const
+{
+  const UnsignedInteger size = sample.getSize();
+  if (outC.getSize() != size)
+    throw InvalidArgumentException(HERE) << "LibSVM: expected " << size << " classes, got " << outC.getSize();
+  std::vector<UnsignedInteger> votes;
+  p_implementation_->computeVotes(sample, votes);
+  const UnsignedInteger classNumber = p_implementation_->p_model_->nr_class;
+  Point result(size);
+  for (UnsignedInteger i = 0; i < size; ++ i)
   {
-    svm_predict_values(p_implementation_->p_model_, x, &res);
-
-    if (svm_get_svm_type(p_implementation_->p_model_) == ONE_CLASS)
-      res = (res > 0) ? 1 : -1;
+    UnsignedInteger res = 0;
+    for (UnsignedInteger j = 0; j < classNumber; ++ j)
+      if ((SignedInteger)p_implementation_->p_model_->label[j] == (SignedInteger)outC[i])
+        res = j;
+    result[i] = votes[i * classNumber + res];
   }
-  else
-  {
-    // multiclass
-    int i;
-    int nr_class = svm_get_nr_class(p_implementation_->p_model_);
-    std::vector<double>dec_values(nr_class * (nr_class - 1) / 2);
-    svm_predict_values(p_implementation_->p_model_, x, dec_values.data());
-
-    std::vector<int> vote(nr_class);
-    for (i = 0; i < nr_class; i++)
-      vote[i] = 0;
-    int pos = 0;
-    for (i = 0; i < nr_class; i++)
-      for (int j = i + 1; j < nr_class; j++)
-      {
-        if (dec_values[pos++] > 0)
-          ++vote[i];
-        else
-          ++vote[j];
-      }
-
-    int vote_max_idx = 0;
-    for (i = 1; i < nr_class; i++)
-      if (vote[i] > vote[vote_max_idx])
-        vote_max_idx = i;
+  return result;
+}
 
-    std::vector<int> labels(nr_class);
-    svm_get_labels(p_implementation_->p_model_, labels.data());
-    int label = labels[vote_max_idx];
 
-    res = (double)label;
-    res = dec_values[0] * labels[0];
-  }
-  free(x);
-  return res;
+Scalar LibSVM::predict(const Point & inP) const
+{
+  const Scalar res = p_implementation_->predictPoint(inP);
+  if (svm_get_svm_type(p_implementation_->p_model_) == ONE_CLASS ||
+      svm_get_svm_type(p_implementation_->p_model_) == EPSILON_SVR ||
+      svm_get_svm_type(p_implementation_->p_model_) == NU_SVR)
+    return res;
+  // first decision value, signed by the first label
+  return GetScratch().decisionValues[0] * p_implementation_->p_model_->label[0];
 }
 
 
@@ -611,10 +1814,20 @@ struct LibSVM_init
   {
     ResourceMap::AddAsUnsignedInteger("LibSVM-DegreePolynomialKernel", 3);
     ResourceMap::AddAsScalar("LibSVM-ConstantPolynomialKernel", 0);
+    ResourceMap::AddAsBool("LibSVM-AdaptiveCacheSize", false);
     ResourceMap::AddAsUnsignedInteger("LibSVM-CacheSize", 100);
+    ResourceMap::AddAsString("LibSVM-CacheStorage", "float");
     ResourceMap::AddAsScalar("LibSVM-Epsilon", 1e-3);
+    ResourceMap::AddAsString("LibSVM-GramStorage", "double");
+    ResourceMap::AddAsUnsignedInteger("LibSVM-GridCacheSize", 512);
+    ResourceMap::AddAsUnsignedInteger("LibSVM-MemoryBudget", 1024);
+    ResourceMap::AddAsBool("LibSVM-RegularizationPath", false);
+    ResourceMap::AddAsBool("LibSVM-UseDenseData", true);
+    ResourceMap::AddAsUnsignedInteger("LibSVM-NumberOfThreads", 0);
     ResourceMap::AddAsUnsignedInteger("SVMRegression-NumberOfFolds", 3);
+    ResourceMap::AddAsUnsignedInteger("SVMRegression-PredictionThreads", 0);
     ResourceMap::AddAsUnsignedInteger("LibSVM-Shrinking", 1);
+    ResourceMap::AddAsBool("SVMKernel-UseVectorization", true);
   }
 };
 
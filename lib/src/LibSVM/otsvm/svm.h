@@ -3,6 +3,11 @@
 
 #define LIBSVM_VERSION 335
 
+/* otsvm additions to the bundled copy, absent from an external libsvm */
+#define LIBSVM_OTSVM_EXTENSIONS
+
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -24,6 +29,22 @@ struct svm_problem
 
 enum { C_SVC, NU_SVC, ONE_CLASS, EPSILON_SVR, NU_SVR };	/* svm_type */
 enum { LINEAR, POLY, RBF, SIGMOID, PRECOMPUTED }; /* kernel_type */
+enum { GRAM_DOUBLE, GRAM_FLOAT }; /* gram_type */
+enum { CACHE_FLOAT, CACHE_BFLOAT16, CACHE_HALF }; /* cache_type */
+
+/* otsvm extension: loops of the solver over the indices [begin, end) of a
+   block, computing what the scalar loops of svm.cpp would, with the same
+   rounding and ties, and returning the first index left to them */
+struct svm_solver_loops
+{
+	int (*max_violation)(const signed char *y, const double *G, const char *alpha_status, char bound_p, char bound_n,
+		int begin, int end, double *Gmax, int *Gmax_idx);
+	int (*min_obj_diff)(const signed char *y, const double *G, const char *alpha_status, char bound_p, char bound_n,
+		const double *QD, const float *Q_i, double QD_i, double y_i, double Gmax,
+		int begin, int end, double *Gmax2, double *obj_diff_min, int *Gmin_idx);
+	int (*update_gradient)(double *G, const float *Q_i, const float *Q_j, double delta_alpha_i, double delta_alpha_j,
+		int begin, int end);
+};
 
 struct svm_parameter
 {
@@ -44,6 +65,45 @@ struct svm_parameter
 	double p;	/* for EPSILON_SVR */
 	int shrinking;	/* use the shrinking heuristics */
 	int probability; /* do probability estimates */
+
+	/* otsvm extension: dense kernel matrix for PRECOMPUTED, used instead of
+	   the kernel values stored in the nodes when not NULL. The nodes then
+	   only hold the serial number: x[i][0].value */
+	const void *gram;	/* gram[(s_i-1)*gram_ld+s_j-1] = K(x_i,x_j) where s_i is the serial number of x_i */
+	int gram_type;	/* GRAM_DOUBLE or GRAM_FLOAT */
+	int gram_ld;	/* leading dimension of gram */
+
+	/* otsvm extension: dense rows for the other kernels, used instead of the
+	   values stored in the nodes when not NULL. The training nodes then only
+	   hold the serial number, other nodes being read as sparse points */
+	const double *dense;	/* dense[(s_i-1)*dense_ld+k] = x_i[k] where s_i is the serial number of x_i */
+	int dense_dim;	/* number of components */
+	int dense_ld;	/* leading dimension of dense */
+
+	/* otsvm extension: number of OpenMP threads of the kernel evaluations,
+	   the OpenMP default if <= 0, ignored without OpenMP */
+	int nr_thread;
+
+	/* otsvm extension: model of the same problem and kernel to start from,
+	   for C_SVC and EPSILON_SVR, its coefficients being kept for a larger C
+	   and shrunk by the ratio of the values of C otherwise. Cold start if NULL */
+	const struct svm_model *warm_start;
+
+	/* otsvm extension: storage of the cached kernel columns. The 16-bit
+	   types hold twice as many columns, but round the kernel values to a
+	   relative precision of 2^-8 for bfloat16 and 2^-11 for half, the
+	   solver still computing in float and double. Half precision is for
+	   bounded kernels only: it overflows beyond 65504 */
+	int cache_type;	/* CACHE_FLOAT, CACHE_BFLOAT16 or CACHE_HALF */
+
+	/* otsvm extension: scheduler of the one-vs-one trainings of C_SVC and
+	   NU_SVC, calling body(k, data) for k in [0, n) in any order and from any
+	   thread, then returning. The n <= max(nr_thread, 1) bodies each train
+	   their share of the pairs with cache_size / n megabytes. Serial if NULL */
+	void (*parallel_for)(int n, void (*body)(int, void *), void *data);
+
+	/* otsvm extension: vectorized loops of the solver, the scalar ones if NULL */
+	const struct svm_solver_loops *solver_loops;
 };
 
 //
@@ -74,6 +134,14 @@ struct svm_model
 
 struct svm_model *svm_train(const struct svm_problem *prob, const struct svm_parameter *param);
 void svm_cross_validation(const struct svm_problem *prob, const struct svm_parameter *param, int nr_fold, double *target);
+/* otsvm extension: kernel matrix gram[i*prob->l+j] = K(x_i, x_j) of the
+   kernel of param, with the very values the solver computes */
+void svm_compute_gram(const struct svm_problem *prob, const struct svm_parameter *param, double *gram);
+/* otsvm extension: svm_compute_gram rounded to single precision */
+void svm_compute_gram_float(const struct svm_problem *prob, const struct svm_parameter *param, float *gram);
+/* otsvm extension: largest memory of the kernel caches alive at once, in
+   bytes, since the previous call */
+size_t svm_cache_peak(void);
 
 int svm_save_model(const char *model_file_name, const struct svm_model *model);
 struct svm_model *svm_load_model(const char *model_file_name);
@@ -86,6 +154,10 @@ int svm_get_nr_sv(const struct svm_model *model);
 double svm_get_svr_probability(const struct svm_model *model);
 
 double svm_predict_values(const struct svm_model *model, const struct svm_node *x, double* dec_values);
+/* otsvm extension: svm_predict_values without allocation, workspace holding
+   svm_predict_workspace_size(model) doubles */
+int svm_predict_workspace_size(const struct svm_model *model);
+double svm_predict_values_workspace(const struct svm_model *model, const struct svm_node *x, double* dec_values, double *workspace);
 double svm_predict(const struct svm_model *model, const struct svm_node *x);
 double svm_predict_probability(const struct svm_model *model, const struct svm_node *x, double* prob_estimates);
 
@@ -7,9 +7,14 @@
 #include <stdarg.h>
 #include <limits.h>
 #include <locale.h>
+#include <atomic>
 #include "svm.h"
 #ifdef _OPENMP
 #include <omp.h>
+static inline int omp_thread_number(int nr_thread)
+{
+	return nr_thread > 0 ? nr_thread : omp_get_max_threads();
+}
 #endif
 
 int libsvm_version = LIBSVM_VERSION;
@@ -42,6 +47,115 @@ static inline double powi(double base, int times)
 #define TAU 1e-12
 #define Malloc(type,n) (type *)malloc((n)*sizeof(type))
 
+// branch-free products of dense rows, with independent partial sums. Each
+// sum keeps its own order, so the compiler maps them onto vector lanes
+// without reassociation: GCC vectorizes both loops from -O2 on (see
+// -fopt-info-vec), with 32-byte vectors when AVX2 is enabled. The padded
+// rows and index lists of SVMKernelVector do not fit the libsvm layout.
+static inline double dense_dot(const double *px, const double *py, int n)
+{
+	double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+	int k = 0;
+	for(;k+4<=n;k+=4)
+	{
+		s0 += px[k]*py[k];
+		s1 += px[k+1]*py[k+1];
+		s2 += px[k+2]*py[k+2];
+		s3 += px[k+3]*py[k+3];
+	}
+	for(;k<n;k++)
+		s0 += px[k]*py[k];
+	return (s0+s1)+(s2+s3);
+}
+
+static inline double dense_distance2(const double *px, const double *py, int n)
+{
+	double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+	int k = 0;
+	for(;k+4<=n;k+=4)
+	{
+		const double d0 = px[k]-py[k];
+		const double d1 = px[k+1]-py[k+1];
+		const double d2 = px[k+2]-py[k+2];
+		const double d3 = px[k+3]-py[k+3];
+		s0 += d0*d0;
+		s1 += d1*d1;
+		s2 += d2*d2;
+		s3 += d3*d3;
+	}
+	for(;k<n;k++)
+	{
+		const double d = px[k]-py[k];
+		s0 += d*d;
+	}
+	return (s0+s1)+(s2+s3);
+}
+
+// 16-bit storage of the cached values, rounded to nearest even. bfloat16
+// keeps the range of float with 8 significant bits, IEEE half precision has
+// 11 significant bits but overflows beyond 65504 and loses the relative
+// precision below 6.1e-5
+static inline unsigned short float_to_bfloat16(float x)
+{
+	unsigned int u;
+	memcpy(&u,&x,sizeof(u));
+	u += 0x7fffu + ((u >> 16) & 1);
+	return (unsigned short)(u >> 16);
+}
+
+static inline float bfloat16_to_float(unsigned short h)
+{
+	unsigned int u = (unsigned int)h << 16;
+	float x;
+	memcpy(&x,&u,sizeof(x));
+	return x;
+}
+
+static inline unsigned short float_to_half(float x)
+{
+	unsigned int u;
+	memcpy(&u,&x,sizeof(u));
+	const unsigned int sign = (u >> 16) & 0x8000u;
+	u &= 0x7fffffffu;
+	if(u >= (143u << 23))	// overflow, infinity or NaN
+		return (unsigned short)(sign | (u > (255u << 23) ? 0x7e00u : 0x7c00u));
+	if(u < (113u << 23))	// subnormal: the addition rounds the mantissa
+	{
+		const unsigned int magic_u = 126u << 23;
+		float f, magic;
+		memcpy(&f,&u,sizeof(f));
+		memcpy(&magic,&magic_u,sizeof(magic));
+		f += magic;
+		memcpy(&u,&f,sizeof(u));
+		return (unsigned short)(sign | (u - magic_u));
+	}
+	u += ((unsigned int)(15 - 127) << 23) + 0xfffu + ((u >> 13) & 1);
+	return (unsigned short)(sign | (u >> 13));
+}
+
+static inline float half_to_float(unsigned short h)
+{
+	unsigned int u = (unsigned int)(h & 0x7fffu) << 13;
+	const unsigned int exponent = u & (0x7c00u << 13);
+	u += (127 - 15) << 23;
+	float x;
+	if(exponent == (0x7c00u << 13))	// infinity or NaN
+		u += (128 - 16) << 23;
+	else if(exponent == 0)	// subnormal, renormalized by the subtraction
+	{
+		const unsigned int magic_u = 113u << 23;
+		float magic;
+		memcpy(&magic,&magic_u,sizeof(magic));
+		u += 1 << 23;
+		memcpy(&x,&u,sizeof(x));
+		x -= magic;
+		memcpy(&u,&x,sizeof(u));
+	}
+	u |= (unsigned int)(h & 0x8000u) << 16;
+	memcpy(&x,&u,sizeof(x));
+	return x;
+}
+
 static void print_string_stdout(const char *s)
 {
 	fputs(s,stdout);
@@ -68,122 +182,232 @@ static void info(const char *fmt,...) {}
 // l is the number of total data items
 // size is the cache size limit in bytes
 //
+// otsvm extension: the columns are fixed-size slots of a single arena,
+// recycled by a clock (second chance) policy instead of being reallocated
+// in a least recently used list. The column returned by the previous call
+// is never evicted, as the solver reads two columns at once
+//
+// otsvm extension: with a 16-bit cache type, the slots hold twice as many
+// columns, and get_data returns them decoded into one of two float buffers,
+// one per column in use. The values filled by the caller are then stored by
+// put_data, which also rounds them in place so that the solver always sees
+// the values kept in the cache
+//
+// memory of the caches alive in the process, and its peak
+static std::atomic<size_t> cache_live(0), cache_peak(0);
+
+static void cache_acquire(size_t size)
+{
+	const size_t live = cache_live += size;
+	size_t peak = cache_peak;
+	while(live > peak && !cache_peak.compare_exchange_weak(peak,live));
+}
+
+static void cache_release(size_t size)
+{
+	cache_live -= size;
+}
+
+size_t svm_cache_peak()
+{
+	return cache_peak.exchange(cache_live);
+}
+
 class Cache
 {
 public:
-	Cache(int l,size_t size);
+	Cache(int l,size_t size,int type = CACHE_FLOAT);
 	~Cache();
 
 	// request data [0,len)
 	// return some position p where [p,len) need to be filled
 	// (p >= len if nothing needs to be filled)
 	int get_data(const int index, Qfloat **data, int len);
+	// store data [start,len) filled after the previous get_data
+	void put_data(Qfloat *data, int start, int len);
 	void swap_index(int i, int j);
+
+	// requests served without any value to fill, and the others
+	size_t hits() const { return nr_hit; }
+	size_t misses() const { return nr_miss; }
 private:
 	int l;
-	size_t size;
-	struct head_t
-	{
-		head_t *prev, *next;	// a circular list
-		Qfloat *data;
-		int len;		// data[0,len) is cached in this entry
+	int nr_slot;
+	int type;
+	Qfloat *arena;	// nr_slot columns of l values
+	unsigned short *arena16;	// the same in a 16-bit type
+	Qfloat *buffer[2];	// decoded columns of a 16-bit type
+	int next_buffer;
+	int *slot;	// slot of each index, -1 if not cached
+	struct slot_t
+	{
+		int index;	// cached index, -1 if free
+		int len;	// data[0,len) is cached in this slot
+		bool referenced;	// second chance of the clock
 	};
-
-	head_t *head;
-	head_t lru_head;
-	void lru_delete(head_t *h);
-	void lru_insert(head_t *h);
+	slot_t *slots;
+	int hand;	// next slot examined by the clock
+	int nr_used;	// slots [nr_used,nr_slot) have never been used
+	int last;	// slot returned by the previous call
+	size_t nr_hit, nr_miss;
+	size_t nr_byte;	// memory of the columns and of their slots
+
+	int evict();
+	void release(int s);
 };
 
-Cache::Cache(int l_,size_t size_):l(l_),size(size_)
+Cache::Cache(int l_,size_t size_,int type_):l(l_),type(type_),arena(NULL),arena16(NULL),next_buffer(0),hand(0),nr_used(0),last(-1),nr_hit(0),nr_miss(0)
 {
-	head = (head_t *)calloc(l,sizeof(head_t));	// initialized to 0
-	size /= sizeof(Qfloat);
-	size_t header_size = l * sizeof(head_t) / sizeof(Qfloat);
+	slot = Malloc(int,l);
+	for(int i=0;i<l;i++)
+		slot[i] = -1;
+	const size_t value_size = type == CACHE_FLOAT ? sizeof(Qfloat) : sizeof(unsigned short);
+	size_t header_size = l * sizeof(int) / value_size;
+	size_t size = size_ / value_size;
 	size = max(size, 2 * (size_t) l + header_size) - header_size;  // cache must be large enough for two columns
-	lru_head.next = lru_head.prev = &lru_head;
+	nr_slot = (int)min(max(size / max((size_t) l, (size_t) 1), (size_t) 2), (size_t) max(l, 2));
+	buffer[0] = buffer[1] = NULL;
+	if(type == CACHE_FLOAT)
+		arena = Malloc(Qfloat,(size_t)nr_slot*l);
+	else
+	{
+		arena16 = Malloc(unsigned short,(size_t)nr_slot*l);
+		buffer[0] = Malloc(Qfloat,l);
+		buffer[1] = Malloc(Qfloat,l);
+	}
+	slots = Malloc(slot_t,nr_slot);
+	for(int s=0;s<nr_slot;s++)
+	{
+		slots[s].index = -1;
+		slots[s].len = 0;
+		slots[s].referenced = false;
+	}
+	nr_byte = (size_t)nr_slot*l*value_size + l*sizeof(int);
+	cache_acquire(nr_byte);
 }
 
 Cache::~Cache()
 {
-	for(head_t *h = lru_head.next; h != &lru_head; h=h->next)
-		free(h->data);
-	free(head);
+	cache_release(nr_byte);
+	free(arena);
+	free(arena16);
+	free(buffer[0]);
+	free(buffer[1]);
+	free(slots);
+	free(slot);
 }
 
-void Cache::lru_delete(head_t *h)
+void Cache::release(int s)
 {
-	// delete from current location
-	h->prev->next = h->next;
-	h->next->prev = h->prev;
+	if(slots[s].index >= 0)
+		slot[slots[s].index] = -1;
+	slots[s].index = -1;
+	slots[s].len = 0;
+	slots[s].referenced = false;
 }
 
-void Cache::lru_insert(head_t *h)
+int Cache::evict()
 {
-	// insert to last position
-	h->next = &lru_head;
-	h->prev = lru_head.prev;
-	h->prev->next = h;
-	h->next->prev = h;
+	// a slot never used, then a free slot or the first one not referenced
+	// since the last sweep
+	if(nr_used < nr_slot)
+		return nr_used++;
+	for(;;)
+	{
+		int s = hand;
+		hand = (hand + 1) % nr_slot;
+		if(s == last)
+			continue;
+		if(slots[s].index < 0 || !slots[s].referenced)
+		{
+			release(s);
+			return s;
+		}
+		slots[s].referenced = false;
+	}
 }
 
 int Cache::get_data(const int index, Qfloat **data, int len)
 {
-	head_t *h = &head[index];
-	if(h->len) lru_delete(h);
-	int more = len - h->len;
-
-	if(more > 0)
+	int s = slot[index];
+	if(s < 0)
 	{
-		// free old space
-		while(size < (size_t)more)
-		{
-			head_t *old = lru_head.next;
-			lru_delete(old);
-			free(old->data);
-			size += old->len;
-			old->data = 0;
-			old->len = 0;
-		}
-
-		// allocate new space
-		h->data = (Qfloat *)realloc(h->data,sizeof(Qfloat)*len);
-		size -= more;  // previous while loop guarantees size >= more and subtraction of size_t variable will not underflow
-		swap(h->len,len);
+		s = evict();
+		slots[s].index = index;
+		slot[index] = s;
 	}
-
-	lru_insert(h);
-	*data = h->data;
+	slot_t &t = slots[s];
+	t.referenced = true;
+	last = s;
+	if(type == CACHE_FLOAT)
+		*data = arena + (size_t)s * l;
+	else
+	{
+		*data = buffer[next_buffer];
+		next_buffer = 1 - next_buffer;
+		const unsigned short *column = arena16 + (size_t)s * l;
+		const int n = min(t.len,len);
+		if(type == CACHE_BFLOAT16)
+			for(int k=0;k<n;k++)
+				(*data)[k] = bfloat16_to_float(column[k]);
+		else
+			for(int k=0;k<n;k++)
+				(*data)[k] = half_to_float(column[k]);
+	}
+	if(t.len >= len)
+	{
+		++nr_hit;
+		return len;
+	}
+	++nr_miss;
+	swap(t.len,len);
 	return len;
 }
 
+void Cache::put_data(Qfloat *data, int start, int len)
+{
+	if(type == CACHE_FLOAT)
+		return;
+	unsigned short *column = arena16 + (size_t)last * l;
+	if(type == CACHE_BFLOAT16)
+		for(int k=start;k<len;k++)
+		{
+			column[k] = float_to_bfloat16(data[k]);
+			data[k] = bfloat16_to_float(column[k]);
+		}
+	else
+		for(int k=start;k<len;k++)
+		{
+			column[k] = float_to_half(data[k]);
+			data[k] = half_to_float(column[k]);
+		}
+}
+
 void Cache::swap_index(int i, int j)
 {
 	if(i==j) return;
 
-	if(head[i].len) lru_delete(&head[i]);
-	if(head[j].len) lru_delete(&head[j]);
-	swap(head[i].data,head[j].data);
-	swap(head[i].len,head[j].len);
-	if(head[i].len) lru_insert(&head[i]);
-	if(head[j].len) lru_insert(&head[j]);
+	// the columns of i and j follow their index
+	swap(slot[i],slot[j]);
+	if(slot[i] >= 0) slots[slot[i]].index = i;
+	if(slot[j] >= 0) slots[slot[j]].index = j;
 
 	if(i>j) swap(i,j);
-	for(head_t *h = lru_head.next; h!=&lru_head; h=h->next)
+	for(int s=0;s<nr_used;s++)
 	{
-		if(h->len > i)
+		slot_t &t = slots[s];
+		if(t.len > i)
 		{
-			if(h->len > j)
-				swap(h->data[i],h->data[j]);
-			else
+			if(t.len > j)
 			{
-				// give up
-				lru_delete(h);
-				free(h->data);
-				size += h->len;
-				h->data = 0;
-				h->len = 0;
+				if(arena)
+					swap(arena[(size_t)s*l+i],arena[(size_t)s*l+j]);
+				else
+					swap(arena16[(size_t)s*l+i],arena16[(size_t)s*l+j]);
 			}
+			else
+				// give up
+				release(s);
 		}
 	}
 }
@@ -215,11 +439,13 @@ public:
 	virtual void swap_index(int i, int j) const	// no so const...
 	{
 		swap(x[i],x[j]);
+		if(row) swap(row[i],row[j]);
 		if(x_square) swap(x_square[i],x_square[j]);
 	}
 protected:
 
 	double (Kernel::*kernel_function)(int i, int j) const;
+	const int nr_thread;
 
 private:
 	const svm_node **x;
@@ -230,6 +456,19 @@ private:
 	const int degree;
 	const double gamma;
 	const double coef0;
+	const void *gram;
+	const int gram_type;
+	const int gram_ld;
+	const int dense_dim;
+	const double **row;	// dense rows, or NULL
+
+	static double gram_value(const void *gram, int gram_type, int gram_ld, double si, double sj)
+	{
+		const size_t k = (size_t)((int)si - 1) * gram_ld + (int)sj - 1;
+		if(gram_type == GRAM_FLOAT)
+			return ((const float *)gram)[k];
+		return ((const double *)gram)[k];
+	}
 
 	static double dot(const svm_node *px, const svm_node *py);
 	double kernel_linear(int i, int j) const
@@ -252,11 +491,35 @@ private:
 	{
 		return x[i][(int)(x[j][0].value)].value;
 	}
+	double kernel_gram(int i, int j) const
+	{
+		return gram_value(gram,gram_type,gram_ld,x[i][0].value,x[j][0].value);
+	}
+	double kernel_linear_dense(int i, int j) const
+	{
+		return dense_dot(row[i],row[j],dense_dim);
+	}
+	double kernel_poly_dense(int i, int j) const
+	{
+		return powi(gamma*dense_dot(row[i],row[j],dense_dim)+coef0,degree);
+	}
+	double kernel_rbf_dense(int i, int j) const
+	{
+		return exp(-gamma*(x_square[i]+x_square[j]-2*dense_dot(row[i],row[j],dense_dim)));
+	}
+	double kernel_sigmoid_dense(int i, int j) const
+	{
+		return tanh(gamma*dense_dot(row[i],row[j],dense_dim)+coef0);
+	}
+	static double dense_k_function(const svm_node *x, const svm_node *y,
+				       const svm_parameter& param);
 };
 
 Kernel::Kernel(int l, svm_node * const * x_, const svm_parameter& param)
-:kernel_type(param.kernel_type), degree(param.degree),
- gamma(param.gamma), coef0(param.coef0)
+:nr_thread(param.nr_thread), kernel_type(param.kernel_type), degree(param.degree),
+ gamma(param.gamma), coef0(param.coef0),
+ gram(param.gram), gram_type(param.gram_type), gram_ld(param.gram_ld),
+ dense_dim(param.dense_dim), row(0)
 {
 	switch(kernel_type)
 	{
@@ -273,17 +536,43 @@ Kernel::Kernel(int l, svm_node * const * x_, const svm_parameter& param)
 			kernel_function = &Kernel::kernel_sigmoid;
 			break;
 		case PRECOMPUTED:
-			kernel_function = &Kernel::kernel_precomputed;
+			if(gram)
+				kernel_function = &Kernel::kernel_gram;
+			else
+				kernel_function = &Kernel::kernel_precomputed;
 			break;
 	}
 
 	clone(x,x_,l);
 
+	if(param.dense && kernel_type != PRECOMPUTED)
+	{
+		// rows located by the serial number of the nodes
+		row = new const double*[l];
+		for(int i=0;i<l;i++)
+			row[i] = param.dense + (size_t)((int)x[i][0].value - 1) * param.dense_ld;
+		switch(kernel_type)
+		{
+			case LINEAR:
+				kernel_function = &Kernel::kernel_linear_dense;
+				break;
+			case POLY:
+				kernel_function = &Kernel::kernel_poly_dense;
+				break;
+			case RBF:
+				kernel_function = &Kernel::kernel_rbf_dense;
+				break;
+			case SIGMOID:
+				kernel_function = &Kernel::kernel_sigmoid_dense;
+				break;
+		}
+	}
+
 	if(kernel_type == RBF)
 	{
 		x_square = new double[l];
 		for(int i=0;i<l;i++)
-			x_square[i] = dot(x[i],x[i]);
+			x_square[i] = row ? dense_dot(row[i],row[i],dense_dim) : dot(x[i],x[i]);
 	}
 	else
 		x_square = 0;
@@ -292,6 +581,7 @@ Kernel::Kernel(int l, svm_node * const * x_, const svm_parameter& param)
 Kernel::~Kernel()
 {
 	delete[] x;
+	delete[] row;
 	delete[] x_square;
 }
 
@@ -317,9 +607,57 @@ double Kernel::dot(const svm_node *px, const svm_node *py)
 	return sum;
 }
 
+// y is a training node with its serial number, x either a training node or
+// a sparse point to be predicted
+double Kernel::dense_k_function(const svm_node *x, const svm_node *y,
+				const svm_parameter& param)
+{
+	const int n = param.dense_dim;
+	const double *py = param.dense + (size_t)((int)y->value - 1) * param.dense_ld;
+	double dot = 0, distance2 = 0;
+	if(x->index == 0)
+	{
+		const double *px = param.dense + (size_t)((int)x->value - 1) * param.dense_ld;
+		if(param.kernel_type == RBF)
+			distance2 = dense_distance2(px,py,n);
+		else
+			dot = dense_dot(px,py,n);
+	}
+	else
+	{
+		int k = 0;
+		for(;x->index != -1;++x)
+		{
+			for(;k<x->index-1;k++)
+				distance2 += py[k]*py[k];
+			const double d = x->value - py[k];
+			distance2 += d*d;
+			dot += x->value*py[k];
+			k++;
+		}
+		for(;k<n;k++)
+			distance2 += py[k]*py[k];
+	}
+	switch(param.kernel_type)
+	{
+		case LINEAR:
+			return dot;
+		case POLY:
+			return powi(param.gamma*dot+param.coef0,param.degree);
+		case RBF:
+			return exp(-param.gamma*distance2);
+		case SIGMOID:
+			return tanh(param.gamma*dot+param.coef0);
+		default:
+			return 0;  // Unreachable
+	}
+}
+
 double Kernel::k_function(const svm_node *x, const svm_node *y,
 			  const svm_parameter& param)
 {
+	if(param.dense && param.kernel_type != PRECOMPUTED)
+		return dense_k_function(x,y,param);
 	switch(param.kernel_type)
 	{
 		case LINEAR:
@@ -370,6 +708,8 @@ double Kernel::k_function(const svm_node *x, const svm_node *y,
 		case SIGMOID:
 			return tanh(param.gamma*dot(x,y)+param.coef0);
 		case PRECOMPUTED:  //x: test (validation), y: SV
+			if(param.gram)
+				return gram_value(param.gram,param.gram_type,param.gram_ld,x->value,y->value);
 			return x[(int)(y->value)].value;
 		default:
 			return 0;  // Unreachable
@@ -394,9 +734,24 @@ double Kernel::k_function(const svm_node *x, const svm_node *y,
 //
 // solution will be put in \alpha, objective value will be put in obj
 //
+//
+// otsvm extension: the O(active_size) loops of an iteration, that is the
+// scans of Solver::select_working_set and the update of G, are split in
+// blocks of indices run concurrently through OpenMP or the parallel_for of
+// the parameters, once active_size is large enough for the threads to pay
+// off. The scans are branch-free, an index out of the candidates having its
+// value pushed to an infinity, and the blocks are merged in their order, so
+// that the selection is the one of the serial loops: the last index among
+// the ties. The solver_loops of the parameters, if any, run the loops of a
+// block first, and the scalar loops go on from the first index they leave
+//
+#define SOLVER_BLOCK_SIZE 16384	// minimum number of indices of a block
+
 class Solver {
 public:
-	Solver() {};
+	Solver(const svm_parameter *param = NULL)
+	:nr_thread(param ? param->nr_thread : 1), parallel_for(param ? param->parallel_for : NULL),
+	 loops(param ? param->solver_loops : NULL) {};
 	virtual ~Solver() {};
 
 	struct SolutionInfo {
@@ -427,6 +782,18 @@ protected:
 	int l;
 	bool unshrink;	// XXX
 
+	const int nr_thread;
+	void (*const parallel_for)(int n, void (*body)(int, void *), void *data);
+	const svm_solver_loops *const loops;
+	struct block_t	// partial results of a block
+	{
+		double Gmax, Gmax2, obj_diff_min;
+		int Gmax_idx, Gmin_idx;
+	};
+	block_t *blocks;
+	int block_number(int n) const;
+	void run_blocks(int nr_block, void (*body)(int, void *), void *data) const;
+
 	double get_C(int i)
 	{
 		return (y[i] > 0)? Cp : Cn;
@@ -449,8 +816,142 @@ protected:
 	virtual void do_shrinking();
 private:
 	bool be_shrunk(int i, double Gmax1, double Gmax2);
+	struct block_data	// arguments of the loops over the blocks
+	{
+		Solver *solver;
+		int n, nr_block;
+		double Gmax;
+		const Qfloat *Q_i, *Q_j;
+		double delta_alpha_i, delta_alpha_j;
+		int i;
+	};
+	static void block_range(const block_data &d, int b, int &begin, int &end);
+	static void max_violation_block(int b, void *data);
+	static void min_obj_diff_block(int b, void *data);
+	static void update_gradient_block(int b, void *data);
 };
 
+int Solver::block_number(int n) const
+{
+	int nr_block = n / SOLVER_BLOCK_SIZE;
+#ifdef _OPENMP
+	nr_block = min(nr_block, omp_thread_number(nr_thread));
+#else
+	nr_block = parallel_for ? min(nr_block, nr_thread) : 1;
+#endif
+	return max(nr_block, 1);
+}
+
+void Solver::run_blocks(int nr_block, void (*body)(int, void *), void *data) const
+{
+	if(nr_block == 1)
+	{
+		body(0, data);
+		return;
+	}
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) num_threads(nr_block)
+	for(int b=0;b<nr_block;b++)
+		body(b, data);
+#else
+	parallel_for(nr_block, body, data);
+#endif
+}
+
+void Solver::block_range(const block_data &d, int b, int &begin, int &end)
+{
+	begin = (int)((long long)b * d.n / d.nr_block);
+	end = (int)((long long)(b + 1) * d.n / d.nr_block);
+}
+
+// i in I_up(\alpha) maximizing -y_i * grad(f)_i
+void Solver::max_violation_block(int b, void *data)
+{
+	const block_data &d = *(const block_data *)data;
+	const Solver &s = *d.solver;
+	// bound out of I_up after the sign of y, and offset of the values out of it
+	static const char bound[2] = { LOWER_BOUND, UPPER_BOUND };
+	static const double offset[2] = { -INF, 0 };
+	int begin, end;
+	block_range(d, b, begin, end);
+	double Gmax = -INF;
+	int Gmax_idx = -1;
+	if(s.loops)
+		begin = s.loops->max_violation(s.y,s.G,s.alpha_status,bound[1],bound[0],begin,end,&Gmax,&Gmax_idx);
+	for(int t=begin;t<end;t++)
+	{
+		const double v = -s.y[t] * s.G[t] + offset[s.alpha_status[t] != bound[s.y[t] > 0]];
+		if(v >= Gmax)
+		{
+			Gmax = v;
+			Gmax_idx = t;
+		}
+	}
+	s.blocks[b].Gmax = Gmax;
+	s.blocks[b].Gmax_idx = Gmax == -INF ? -1 : Gmax_idx;
+}
+
+// maximum of -y_j * grad(f)_j in I_low(\alpha), and j in I_low(\alpha)
+// minimizing the decrease of obj value with -y_j*grad(f)_j < -y_i*grad(f)_i
+void Solver::min_obj_diff_block(int b, void *data)
+{
+	const block_data &d = *(const block_data *)data;
+	const Solver &s = *d.solver;
+	// bound out of I_low after the sign of y, and offsets of the values out of it
+	static const char bound[2] = { UPPER_BOUND, LOWER_BOUND };
+	static const double offset[2] = { -INF, 0 };
+	static const double obj_offset[2] = { INF, 0 };
+	int begin, end;
+	block_range(d, b, begin, end);
+	const double Gmax = d.Gmax;
+	const Qfloat *Q_i = d.Q_i;
+	const double QD_i = s.QD[d.i];
+	const double y_i = 2.0 * s.y[d.i];
+	double Gmax2 = -INF;
+	double obj_diff_min = INF;
+	int Gmin_idx = -1;
+	if(s.loops)
+		begin = s.loops->min_obj_diff(s.y,s.G,s.alpha_status,bound[1],bound[0],s.QD,Q_i,QD_i,y_i,Gmax,begin,end,&Gmax2,&obj_diff_min,&Gmin_idx);
+	for(int j=begin;j<end;j++)
+	{
+		const int in_low = s.alpha_status[j] != bound[s.y[j] > 0];
+		const double yG = s.y[j] * s.G[j];
+		const double v = yG + offset[in_low];
+		if(v >= Gmax2)
+			Gmax2 = v;
+		const double grad_diff = Gmax + yG;
+		double quad_coef = QD_i + s.QD[j] - y_i * s.y[j] * Q_i[j];
+		if(quad_coef <= 0)
+			quad_coef = TAU;
+		const double obj_diff = -(grad_diff * grad_diff) / quad_coef + obj_offset[in_low & (grad_diff > 0)];
+		if(obj_diff <= obj_diff_min)
+		{
+			obj_diff_min = obj_diff;
+			Gmin_idx = j;
+		}
+	}
+	s.blocks[b].Gmax2 = Gmax2;
+	s.blocks[b].obj_diff_min = obj_diff_min;
+	s.blocks[b].Gmin_idx = obj_diff_min == INF ? -1 : Gmin_idx;
+}
+
+void Solver::update_gradient_block(int b, void *data)
+{
+	const block_data &d = *(const block_data *)data;
+	double *G = d.solver->G;
+	const Qfloat *Q_i = d.Q_i;
+	const Qfloat *Q_j = d.Q_j;
+	const double delta_alpha_i = d.delta_alpha_i;
+	const double delta_alpha_j = d.delta_alpha_j;
+	int begin, end;
+	block_range(d, b, begin, end);
+	const svm_solver_loops *loops = d.solver->loops;
+	if(loops)
+		begin = loops->update_gradient(G,Q_i,Q_j,delta_alpha_i,delta_alpha_j,begin,end);
+	for(int k=begin;k<end;k++)
+		G[k] += Q_i[k]*delta_alpha_i + Q_j[k]*delta_alpha_j;
+}
+
 void Solver::swap_index(int i, int j)
 {
 	Q->swap_index(i,j);
@@ -535,6 +1036,8 @@ void Solver::Solve(int l, const QMatrix& Q, const double *p_, const schar *y_,
 		active_size = l;
 	}
 
+	blocks = new block_t[block_number(l)];
+
 	// initialize gradient
 	{
 		G = new double[l];
@@ -695,9 +1198,16 @@ void Solver::Solve(int l, const QMatrix& Q, const double *p_, const schar *y_,
 		double delta_alpha_i = alpha[i] - old_alpha_i;
 		double delta_alpha_j = alpha[j] - old_alpha_j;
 
-		for(int k=0;k<active_size;k++)
 		{
-			G[k] += Q_i[k]*delta_alpha_i + Q_j[k]*delta_alpha_j;
+			block_data d;
+			d.solver = this;
+			d.n = active_size;
+			d.nr_block = block_number(active_size);
+			d.Q_i = Q_i;
+			d.Q_j = Q_j;
+			d.delta_alpha_i = delta_alpha_i;
+			d.delta_alpha_j = delta_alpha_j;
+			run_blocks(d.nr_block,&update_gradient_block,&d);
 		}
 
 		// update alpha_status and G_bar
@@ -784,6 +1294,7 @@ void Solver::Solve(int l, const QMatrix& Q, const double *p_, const schar *y_,
 	delete[] active_set;
 	delete[] G;
 	delete[] G_bar;
+	delete[] blocks;
 }
 
 // return 1 if already optimal, return 0 otherwise
@@ -795,86 +1306,41 @@ int Solver::select_working_set(int &out_i, int &out_j)
 	//    (if quadratic coefficeint <= 0, replace it with tau)
 	//    -y_j*grad(f)_j < -y_i*grad(f)_i, j in I_low(\alpha)
 
+	block_data d;
+	d.solver = this;
+	d.n = active_size;
+	d.nr_block = block_number(active_size);
+	int b;
+
+	run_blocks(d.nr_block,&max_violation_block,&d);
 	double Gmax = -INF;
-	double Gmax2 = -INF;
 	int Gmax_idx = -1;
-	int Gmin_idx = -1;
-	double obj_diff_min = INF;
-
-	for(int t=0;t<active_size;t++)
-		if(y[t]==+1)
+	for(b=0;b<d.nr_block;b++)
+		if(blocks[b].Gmax_idx != -1 && blocks[b].Gmax >= Gmax)
 		{
-			if(!is_upper_bound(t))
-				if(-G[t] >= Gmax)
-				{
-					Gmax = -G[t];
-					Gmax_idx = t;
-				}
-		}
-		else
-		{
-			if(!is_lower_bound(t))
-				if(G[t] >= Gmax)
-				{
-					Gmax = G[t];
-					Gmax_idx = t;
-				}
+			Gmax = blocks[b].Gmax;
+			Gmax_idx = blocks[b].Gmax_idx;
 		}
 
 	int i = Gmax_idx;
-	const Qfloat *Q_i = NULL;
-	if(i != -1) // NULL Q_i not accessed: Gmax=-INF if i=-1
-		Q_i = Q->get_Q(i,active_size);
+	if(i == -1) // already optimal: Gmax=-INF
+		return 1;
+	d.Gmax = Gmax;
+	d.i = i;
+	d.Q_i = Q->get_Q(i,active_size);
 
-	for(int j=0;j<active_size;j++)
+	run_blocks(d.nr_block,&min_obj_diff_block,&d);
+	double Gmax2 = -INF;
+	int Gmin_idx = -1;
+	double obj_diff_min = INF;
+	for(b=0;b<d.nr_block;b++)
 	{
-		if(y[j]==+1)
-		{
-			if (!is_lower_bound(j))
-			{
-				double grad_diff=Gmax+G[j];
-				if (G[j] >= Gmax2)
-					Gmax2 = G[j];
-				if (grad_diff > 0)
-				{
-					double obj_diff;
-					double quad_coef = QD[i]+QD[j]-2.0*y[i]*Q_i[j];
-					if (quad_coef > 0)
-						obj_diff = -(grad_diff*grad_diff)/quad_coef;
-					else
-						obj_diff = -(grad_diff*grad_diff)/TAU;
-
-					if (obj_diff <= obj_diff_min)
-					{
-						Gmin_idx=j;
-						obj_diff_min = obj_diff;
-					}
-				}
-			}
-		}
-		else
+		if(blocks[b].Gmax2 >= Gmax2)
+			Gmax2 = blocks[b].Gmax2;
+		if(blocks[b].Gmin_idx != -1 && blocks[b].obj_diff_min <= obj_diff_min)
 		{
-			if (!is_upper_bound(j))
-			{
-				double grad_diff= Gmax-G[j];
-				if (-G[j] >= Gmax2)
-					Gmax2 = -G[j];
-				if (grad_diff > 0)
-				{
-					double obj_diff;
-					double quad_coef = QD[i]+QD[j]+2.0*y[i]*Q_i[j];
-					if (quad_coef > 0)
-						obj_diff = -(grad_diff*grad_diff)/quad_coef;
-					else
-						obj_diff = -(grad_diff*grad_diff)/TAU;
-
-					if (obj_diff <= obj_diff_min)
-					{
-						Gmin_idx=j;
-						obj_diff_min = obj_diff;
-					}
-				}
-			}
+			obj_diff_min = blocks[b].obj_diff_min;
+			Gmin_idx = blocks[b].Gmin_idx;
 		}
 	}
 
@@ -1013,7 +1479,7 @@ double Solver::calculate_rho()
 class Solver_NU: public Solver
 {
 public:
-	Solver_NU() {}
+	Solver_NU(const svm_parameter *param = NULL) : Solver(param) {}
 	void Solve(int l, const QMatrix& Q, const double *p, const schar *y,
 		   double *alpha, double Cp, double Cn, double eps,
 		   SolutionInfo* si, int shrinking)
@@ -1274,7 +1740,7 @@ public:
 	:Kernel(prob.l, prob.x, param)
 	{
 		clone(y,y_,prob.l);
-		cache = new Cache(prob.l,(size_t)(param.cache_size*(1<<20)));
+		cache = new Cache(prob.l,(size_t)(param.cache_size*(1<<20)),param.cache_type);
 		QD = new double[prob.l];
 		for(int i=0;i<prob.l;i++)
 			QD[i] = (this->*kernel_function)(i,i);
@@ -1287,10 +1753,11 @@ public:
 		if((start = cache->get_data(i,&data,len)) < len)
 		{
 #ifdef _OPENMP
-#pragma omp parallel for private(j) schedule(guided)
+#pragma omp parallel for private(j) schedule(guided) num_threads(omp_thread_number(nr_thread))
 #endif
 			for(j=start;j<len;j++)
 				data[j] = (Qfloat)(y[i]*y[j]*(this->*kernel_function)(i,j));
+			cache->put_data(data,start,len);
 		}
 		return data;
 	}
@@ -1311,6 +1778,7 @@ public:
 	~SVC_Q()
 	{
 		delete[] y;
+		info("cache hits = %lu, misses = %lu\n",(unsigned long)cache->hits(),(unsigned long)cache->misses());
 		delete cache;
 		delete[] QD;
 	}
@@ -1326,7 +1794,7 @@ public:
 	ONE_CLASS_Q(const svm_problem& prob, const svm_parameter& param)
 	:Kernel(prob.l, prob.x, param)
 	{
-		cache = new Cache(prob.l,(size_t)(param.cache_size*(1<<20)));
+		cache = new Cache(prob.l,(size_t)(param.cache_size*(1<<20)),param.cache_type);
 		QD = new double[prob.l];
 		for(int i=0;i<prob.l;i++)
 			QD[i] = (this->*kernel_function)(i,i);
@@ -1340,6 +1808,7 @@ public:
 		{
 			for(j=start;j<len;j++)
 				data[j] = (Qfloat)(this->*kernel_function)(i,j);
+			cache->put_data(data,start,len);
 		}
 		return data;
 	}
@@ -1358,6 +1827,7 @@ public:
 
 	~ONE_CLASS_Q()
 	{
+		info("cache hits = %lu, misses = %lu\n",(unsigned long)cache->hits(),(unsigned long)cache->misses());
 		delete cache;
 		delete[] QD;
 	}
@@ -1373,7 +1843,7 @@ public:
 	:Kernel(prob.l, prob.x, param)
 	{
 		l = prob.l;
-		cache = new Cache(l,(size_t)(param.cache_size*(1<<20)));
+		cache = new Cache(l,(size_t)(param.cache_size*(1<<20)),param.cache_type);
 		QD = new double[2*l];
 		sign = new schar[2*l];
 		index = new int[2*l];
@@ -1401,14 +1871,15 @@ public:
 	Qfloat *get_Q(int i, int len) const
 	{
 		Qfloat *data;
-		int j, real_i = index[i];
-		if(cache->get_data(real_i,&data,l) < l)
+		int j, start, real_i = index[i];
+		if((start = cache->get_data(real_i,&data,l)) < l)
 		{
 #ifdef _OPENMP
-#pragma omp parallel for private(j) schedule(guided)
+#pragma omp parallel for private(j) schedule(guided) num_threads(omp_thread_number(nr_thread))
 #endif
 			for(j=0;j<l;j++)
 				data[j] = (Qfloat)(this->*kernel_function)(real_i,j);
+			cache->put_data(data,start,l);
 		}
 
 		// reorder and copy
@@ -1427,6 +1898,7 @@ public:
 
 	~SVR_Q()
 	{
+		info("cache hits = %lu, misses = %lu\n",(unsigned long)cache->hits(),(unsigned long)cache->misses());
 		delete cache;
 		delete[] sign;
 		delete[] index;
@@ -1444,12 +1916,72 @@ private:
 	double *QD;
 };
 
+// otsvm extension: plain kernel values of a problem, computed by the same
+// kernel functions as the Q matrices above
+class Gram_Q: public Kernel
+{
+public:
+	Gram_Q(const svm_problem& prob, const svm_parameter& param)
+	:Kernel(prob.l, prob.x, param)
+	{
+	}
+
+	double value(int i, int j) const
+	{
+		return (this->*kernel_function)(i,j);
+	}
+
+	Qfloat *get_Q(int, int) const
+	{
+		return 0;
+	}
+
+	double *get_QD() const
+	{
+		return 0;
+	}
+};
+
+template <class T>
+static void compute_gram(const svm_problem *prob, const svm_parameter *param, T *gram)
+{
+	const Gram_Q kernel(*prob,*param);
+	const int l = prob->l;
+	int i;
+#ifdef _OPENMP
+#pragma omp parallel for private(i) schedule(guided) num_threads(omp_thread_number(param->nr_thread))
+#endif
+	for(i=0;i<l;i++)
+		for(int j=0;j<=i;j++)
+			gram[(size_t)i*l+j] = gram[(size_t)j*l+i] = (T)kernel.value(i,j);
+}
+
+void svm_compute_gram(const svm_problem *prob, const svm_parameter *param, double *gram)
+{
+	compute_gram(prob, param, gram);
+}
+
+void svm_compute_gram_float(const svm_problem *prob, const svm_parameter *param, float *gram)
+{
+	compute_gram(prob, param, gram);
+}
+
 //
 // construct and solve various formulations
 //
+// otsvm extension: initial coefficients y_i*alpha_i, or alpha_i-alpha_i* for
+// EPSILON_SVR, the solver starting from the matching feasible point
+static double warm_alpha(const double *alpha_init, int i, schar sign, double upper_bound)
+{
+	if(!alpha_init)
+		return 0;
+	return min(max(sign*alpha_init[i],0.0),upper_bound);
+}
+
 static void solve_c_svc(
 	const svm_problem *prob, const svm_parameter* param,
-	double *alpha, Solver::SolutionInfo* si, double Cp, double Cn)
+	double *alpha, Solver::SolutionInfo* si, double Cp, double Cn,
+	const double *alpha_init)
 {
 	int l = prob->l;
 	double *minus_ones = new double[l];
@@ -1459,12 +1991,12 @@ static void solve_c_svc(
 
 	for(i=0;i<l;i++)
 	{
-		alpha[i] = 0;
 		minus_ones[i] = -1;
 		if(prob->y[i] > 0) y[i] = +1; else y[i] = -1;
+		alpha[i] = warm_alpha(alpha_init,i,y[i],y[i] > 0 ? Cp : Cn);
 	}
 
-	Solver s;
+	Solver s(param);
 	s.Solve(l, SVC_Q(*prob,*param,y), minus_ones, y,
 		alpha, Cp, Cn, param->eps, si, param->shrinking);
 
@@ -1518,7 +2050,7 @@ static void solve_nu_svc(
 	for(i=0;i<l;i++)
 		zeros[i] = 0;
 
-	Solver_NU s;
+	Solver_NU s(param);
 	s.Solve(l, SVC_Q(*prob,*param,y), zeros, y,
 		alpha, 1.0, 1.0, param->eps, si,  param->shrinking);
 	double r = si->r;
@@ -1561,7 +2093,7 @@ static void solve_one_class(
 		ones[i] = 1;
 	}
 
-	Solver s;
+	Solver s(param);
 	s.Solve(l, ONE_CLASS_Q(*prob,*param), zeros, ones,
 		alpha, 1.0, 1.0, param->eps, si, param->shrinking);
 
@@ -1571,7 +2103,8 @@ static void solve_one_class(
 
 static void solve_epsilon_svr(
 	const svm_problem *prob, const svm_parameter *param,
-	double *alpha, Solver::SolutionInfo* si)
+	double *alpha, Solver::SolutionInfo* si,
+	const double *alpha_init)
 {
 	int l = prob->l;
 	double *alpha2 = new double[2*l];
@@ -1581,16 +2114,16 @@ static void solve_epsilon_svr(
 
 	for(i=0;i<l;i++)
 	{
-		alpha2[i] = 0;
+		alpha2[i] = warm_alpha(alpha_init,i,+1,param->C);
 		linear_term[i] = param->p - prob->y[i];
 		y[i] = 1;
 
-		alpha2[i+l] = 0;
+		alpha2[i+l] = warm_alpha(alpha_init,i,-1,param->C);
 		linear_term[i+l] = param->p + prob->y[i];
 		y[i+l] = -1;
 	}
 
-	Solver s;
+	Solver s(param);
 	s.Solve(2*l, SVR_Q(*prob,*param), linear_term, y,
 		alpha2, param->C, param->C, param->eps, si, param->shrinking);
 
@@ -1631,7 +2164,7 @@ static void solve_nu_svr(
 		y[i+l] = -1;
 	}
 
-	Solver_NU s;
+	Solver_NU s(param);
 	s.Solve(2*l, SVR_Q(*prob,*param), linear_term, y,
 		alpha2, C, C, param->eps, si, param->shrinking);
 
@@ -1654,16 +2187,23 @@ struct decision_function
 	double rho;
 };
 
+// otsvm extension: the coefficients of the warm start model stay feasible
+// for a larger C, and are shrunk for a smaller one
+static double svm_warm_start_scale(const svm_parameter *param, const svm_model *warm)
+{
+	return min(1.0,param->C/warm->param.C);
+}
+
 static decision_function svm_train_one(
 	const svm_problem *prob, const svm_parameter *param,
-	double Cp, double Cn)
+	double Cp, double Cn, const double *alpha_init = NULL)
 {
 	double *alpha = Malloc(double,prob->l);
 	Solver::SolutionInfo si;
 	switch(param->svm_type)
 	{
 		case C_SVC:
-			solve_c_svc(prob,param,alpha,&si,Cp,Cn);
+			solve_c_svc(prob,param,alpha,&si,Cp,Cn,alpha_init);
 			break;
 		case NU_SVC:
 			solve_nu_svc(prob,param,alpha,&si);
@@ -1672,7 +2212,7 @@ static decision_function svm_train_one(
 			solve_one_class(prob,param,alpha,&si);
 			break;
 		case EPSILON_SVR:
-			solve_epsilon_svr(prob,param,alpha,&si);
+			solve_epsilon_svr(prob,param,alpha,&si,alpha_init);
 			break;
 		case NU_SVR:
 			solve_nu_svr(prob,param,alpha,&si);
@@ -1959,6 +2499,7 @@ static void svm_binary_svc_probability(
 		else
 		{
 			svm_parameter subparam = *param;
+			subparam.warm_start = NULL;
 			subparam.probability=0;
 			subparam.C=1.0;
 			subparam.nr_weight=2;
@@ -2073,6 +2614,7 @@ static double svm_svr_probability(
 	double mae = 0;
 
 	svm_parameter newparam = *param;
+	newparam.warm_start = NULL;
 	newparam.probability = 0;
 	svm_cross_validation(prob,&newparam,nr_fold,ymv);
 	for(i=0;i<prob->l;i++)
@@ -2173,6 +2715,77 @@ static void svm_group_classes(const svm_problem *prob, int *nr_class_ret, int **
 	free(data_label);
 }
 
+// otsvm extension: training of the one-vs-one classifiers, possibly
+// scheduled concurrently through svm_parameter.parallel_for
+static void svm_build_pair_problem(svm_node **x, const int *start, const int *count, int i, int j, svm_problem *sub_prob)
+{
+	int si = start[i], sj = start[j];
+	int ci = count[i], cj = count[j];
+	sub_prob->l = ci+cj;
+	sub_prob->x = Malloc(svm_node *,sub_prob->l);
+	sub_prob->y = Malloc(double,sub_prob->l);
+	int k;
+	for(k=0;k<ci;k++)
+	{
+		sub_prob->x[k] = x[si+k];
+		sub_prob->y[k] = +1;
+	}
+	for(k=0;k<cj;k++)
+	{
+		sub_prob->x[ci+k] = x[sj+k];
+		sub_prob->y[ci+k] = -1;
+	}
+}
+
+struct svm_pair_data
+{
+	const svm_parameter *param;
+	svm_node **x;
+	const int *start;
+	const int *count;
+	const int *perm;
+	int l;
+	const double *weighted_C;
+	const double *warm_coef;
+	const int *pair_i;
+	const int *pair_j;
+	int nr_pair;
+	int nr_solver;
+	decision_function *f;
+};
+
+static void svm_train_pair(int p, void *data)
+{
+	const svm_pair_data *d = (const svm_pair_data *)data;
+	int i = d->pair_i[p], j = d->pair_j[p];
+	svm_problem sub_prob;
+	svm_build_pair_problem(d->x,d->start,d->count,i,j,&sub_prob);
+	double *alpha_init = NULL;
+	if(d->warm_coef)
+	{
+		int si = d->start[i], sj = d->start[j];
+		int ci = d->count[i], cj = d->count[j];
+		alpha_init = Malloc(double,sub_prob.l);
+		for(int k=0;k<ci;k++)
+			alpha_init[k] = d->warm_coef[(size_t)(j-1)*d->l+d->perm[si+k]];
+		for(int k=0;k<cj;k++)
+			alpha_init[ci+k] = d->warm_coef[(size_t)i*d->l+d->perm[sj+k]];
+	}
+	d->f[p] = svm_train_one(&sub_prob,d->param,d->weighted_C[i],d->weighted_C[j],alpha_init);
+	free(alpha_init);
+	free(sub_prob.x);
+	free(sub_prob.y);
+}
+
+// the pairs s, s+nr_solver, ... one after the other, so that at most
+// nr_solver solvers and their caches are alive at once
+static void svm_train_pairs(int s, void *data)
+{
+	const svm_pair_data *d = (const svm_pair_data *)data;
+	for(int p=s;p<d->nr_pair;p+=d->nr_solver)
+		svm_train_pair(p,data);
+}
+
 //
 // Interface functions
 //
@@ -2180,6 +2793,7 @@ svm_model *svm_train(const svm_problem *prob, const svm_parameter *param)
 {
 	svm_model *model = Malloc(svm_model,1);
 	model->param = *param;
+	model->param.warm_start = NULL;
 	model->free_sv = 0;	// XXX
 
 	if(param->svm_type == ONE_CLASS ||
@@ -2194,7 +2808,20 @@ svm_model *svm_train(const svm_problem *prob, const svm_parameter *param)
 		model->prob_density_marks = NULL;
 		model->sv_coef = Malloc(double *,1);
 
-		decision_function f = svm_train_one(prob,param,0,0);
+		// coefficients of the warm start model, rescaled to the new box
+		double *alpha_init = NULL;
+		const svm_model *warm = param->warm_start;
+		if(warm && param->svm_type == EPSILON_SVR && warm->param.C > 0 && warm->sv_indices)
+		{
+			const double scale = svm_warm_start_scale(param,warm);
+			alpha_init = Malloc(double,prob->l);
+			for(int i=0;i<prob->l;i++)
+				alpha_init[i] = 0;
+			for(int k=0;k<warm->l;k++)
+				alpha_init[warm->sv_indices[k]-1] = warm->sv_coef[0][k]*scale;
+		}
+		decision_function f = svm_train_one(prob,param,0,0,alpha_init);
+		free(alpha_init);
 		model->rho = Malloc(double,1);
 		model->rho[0] = f.rho;
 
@@ -2287,43 +2914,76 @@ svm_model *svm_train(const svm_problem *prob, const svm_parameter *param)
 			probB=Malloc(double,nr_class*(nr_class-1)/2);
 		}
 
+		// coefficients of the warm start model in each classifier, by point,
+		// rescaled to the new box: row j-1 for class i and row i for class j
+		double *warm_coef = NULL;
+		const svm_model *warm = param->warm_start;
+		if(warm && warm->nr_class == nr_class && warm->param.C > 0 && warm->sv_indices && !param->probability)
+		{
+			int same_label = 1;
+			for(i=0;i<nr_class;i++)
+				if(warm->label[i] != label[i])
+					same_label = 0;
+			if(same_label && nr_class > 1)
+			{
+				const double scale = svm_warm_start_scale(param,warm);
+				warm_coef = Malloc(double,(size_t)(nr_class-1)*l);
+				for(i=0;i<(nr_class-1)*l;i++)
+					warm_coef[i] = 0;
+				for(int k=0;k<warm->l;k++)
+					for(int m=0;m<nr_class-1;m++)
+						warm_coef[(size_t)m*l+warm->sv_indices[k]-1] = warm->sv_coef[m][k]*scale;
+			}
+		}
+		// the probability estimates draw random folds, in the order of the pairs
+		int nr_pair = nr_class*(nr_class-1)/2;
+		int *pair_i = Malloc(int,nr_pair);
+		int *pair_j = Malloc(int,nr_pair);
 		int p = 0;
 		for(i=0;i<nr_class;i++)
 			for(int j=i+1;j<nr_class;j++)
 			{
-				svm_problem sub_prob;
-				int si = start[i], sj = start[j];
-				int ci = count[i], cj = count[j];
-				sub_prob.l = ci+cj;
-				sub_prob.x = Malloc(svm_node *,sub_prob.l);
-				sub_prob.y = Malloc(double,sub_prob.l);
-				int k;
-				for(k=0;k<ci;k++)
-				{
-					sub_prob.x[k] = x[si+k];
-					sub_prob.y[k] = +1;
-				}
-				for(k=0;k<cj;k++)
-				{
-					sub_prob.x[ci+k] = x[sj+k];
-					sub_prob.y[ci+k] = -1;
-				}
-
+				pair_i[p] = i;
+				pair_j[p] = j;
 				if(param->probability)
+				{
+					svm_problem sub_prob;
+					svm_build_pair_problem(x,start,count,i,j,&sub_prob);
 					svm_binary_svc_probability(&sub_prob,param,weighted_C[i],weighted_C[j],probA[p],probB[p]);
-
-				f[p] = svm_train_one(&sub_prob,param,weighted_C[i],weighted_C[j]);
-				for(k=0;k<ci;k++)
-					if(!nonzero[si+k] && fabs(f[p].alpha[k]) > 0)
-						nonzero[si+k] = true;
-				for(k=0;k<cj;k++)
-					if(!nonzero[sj+k] && fabs(f[p].alpha[ci+k]) > 0)
-						nonzero[sj+k] = true;
-				free(sub_prob.x);
-				free(sub_prob.y);
+					free(sub_prob.x);
+					free(sub_prob.y);
+				}
 				++p;
 			}
 
+		// the pairs are independent: up to nr_thread solvers share the
+		// threads and the cache memory of the solver
+		svm_parameter pair_param = *param;
+		const int nr_solver = param->parallel_for ? min(nr_pair,max(param->nr_thread,1)) : 1;
+		pair_param.nr_thread = nr_solver > 1 ? max(1,param->nr_thread/nr_solver) : param->nr_thread;
+		pair_param.cache_size = param->cache_size/nr_solver;
+		svm_pair_data pair_data = {&pair_param,x,start,count,perm,l,weighted_C,warm_coef,pair_i,pair_j,nr_pair,nr_solver,f};
+		if(nr_solver > 1)
+			param->parallel_for(nr_solver,&svm_train_pairs,&pair_data);
+		else
+			svm_train_pairs(0,&pair_data);
+
+		// support vectors of the pairs, merged in the order of the pairs
+		for(p=0;p<nr_pair;p++)
+		{
+			int si = start[pair_i[p]], sj = start[pair_j[p]];
+			int ci = count[pair_i[p]], cj = count[pair_j[p]];
+			int k;
+			for(k=0;k<ci;k++)
+				if(!nonzero[si+k] && fabs(f[p].alpha[k]) > 0)
+					nonzero[si+k] = true;
+			for(k=0;k<cj;k++)
+				if(!nonzero[sj+k] && fabs(f[p].alpha[ci+k]) > 0)
+					nonzero[sj+k] = true;
+		}
+		free(pair_i);
+		free(pair_j);
+
 		// build output
 
 		model->nr_class = nr_class;
@@ -2430,6 +3090,7 @@ svm_model *svm_train(const svm_problem *prob, const svm_parameter *param)
 		free(f);
 		free(nz_count);
 		free(nz_start);
+		free(warm_coef);
 	}
 	return model;
 }
@@ -2597,7 +3258,14 @@ double svm_get_svr_probability(const svm_model *model)
 	}
 }
 
-double svm_predict_values(const svm_model *model, const svm_node *x, double* dec_values)
+int svm_predict_workspace_size(const svm_model *model)
+{
+	// kernel values, then start and vote as int
+	const int nr_int = 2*model->nr_class;
+	return model->l + (int)((nr_int*sizeof(int)+sizeof(double)-1)/sizeof(double));
+}
+
+double svm_predict_values_workspace(const svm_model *model, const svm_node *x, double* dec_values, double *workspace)
 {
 	int i;
 	if(model->param.svm_type == ONE_CLASS ||
@@ -2607,7 +3275,7 @@ double svm_predict_values(const svm_model *model, const svm_node *x, double* dec
 		double *sv_coef = model->sv_coef[0];
 		double sum = 0;
 #ifdef _OPENMP
-#pragma omp parallel for private(i) reduction(+:sum) schedule(guided)
+#pragma omp parallel for private(i) reduction(+:sum) schedule(guided) num_threads(omp_thread_number(model->param.nr_thread))
 #endif
 		for(i=0;i<model->l;i++)
 			sum += sv_coef[i] * Kernel::k_function(x,model->SV[i],model->param);
@@ -2624,19 +3292,19 @@ double svm_predict_values(const svm_model *model, const svm_node *x, double* dec
 		int nr_class = model->nr_class;
 		int l = model->l;
 
-		double *kvalue = Malloc(double,l);
+		double *kvalue = workspace;
 #ifdef _OPENMP
-#pragma omp parallel for private(i) schedule(guided)
+#pragma omp parallel for private(i) schedule(guided) num_threads(omp_thread_number(model->param.nr_thread))
 #endif
 		for(i=0;i<l;i++)
 			kvalue[i] = Kernel::k_function(x,model->SV[i],model->param);
 
-		int *start = Malloc(int,nr_class);
+		int *start = (int *)(workspace+l);
 		start[0] = 0;
 		for(i=1;i<nr_class;i++)
 			start[i] = start[i-1]+model->nSV[i-1];
 
-		int *vote = Malloc(int,nr_class);
+		int *vote = start+nr_class;
 		for(i=0;i<nr_class;i++)
 			vote[i] = 0;
 
@@ -2672,13 +3340,22 @@ double svm_predict_values(const svm_model *model, const svm_node *x, double* dec
 			if(vote[i] > vote[vote_max_idx])
 				vote_max_idx = i;
 
-		free(kvalue);
-		free(start);
-		free(vote);
 		return model->label[vote_max_idx];
 	}
 }
 
+double svm_predict_values(const svm_model *model, const svm_node *x, double* dec_values)
+{
+	double *workspace = NULL;
+	if(model->param.svm_type != ONE_CLASS &&
+	   model->param.svm_type != EPSILON_SVR &&
+	   model->param.svm_type != NU_SVR)
+		workspace = Malloc(double,svm_predict_workspace_size(model));
+	double pred_result = svm_predict_values_workspace(model, x, dec_values, workspace);
+	free(workspace);
+	return pred_result;
+}
+
 double svm_predict(const svm_model *model, const svm_node *x)
 {
 	int nr_class = model->nr_class;
@@ -3026,6 +3703,13 @@ svm_model *svm_load_model(const char *model_file_name)
 	// read parameters
 
 	svm_model *model = Malloc(svm_model,1);
+	model->param.gram = NULL;
+	model->param.dense = NULL;
+	model->param.warm_start = NULL;
+	model->param.parallel_for = NULL;
+	model->param.solver_loops = NULL;
+	model->param.nr_thread = 0;
+	model->param.cache_type = CACHE_FLOAT;
 	model->rho = NULL;
 	model->probA = NULL;
 	model->probB = NULL;
@@ -3209,6 +3893,11 @@ const char *svm_check_parameter(const svm_problem *prob, const svm_parameter *pa
 	if(param->cache_size <= 0)
 		return "cache_size <= 0";
 
+	if(param->cache_type != CACHE_FLOAT &&
+	   param->cache_type != CACHE_BFLOAT16 &&
+	   param->cache_type != CACHE_HALF)
+		return "unknown cache type";
+
 	if(param->eps <= 0)
 		return "eps <= 0";
 
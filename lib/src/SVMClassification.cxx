@@ -98,14 +98,15 @@ void SVMClassification::run()
 
   if (tradeoffFactor_.getSize() > 1 || kernelParameter_.getSize() > 1)
   {
+    // the cells of the grid are cross-validated in parallel, kernel parameter
+    // first; ties still go to the first minimum with the tradeoff factor first
+    const Sample error(driver_.runCrossValidation(tradeoffFactor_, kernelParameter_));
     Scalar minerror = SpecFunc::MaxScalar;
     for (UnsignedInteger tradeoffIndex = 0 ; tradeoffIndex < tradeoffFactor_.getSize(); ++ tradeoffIndex)
     {
-      driver_.setTradeoffFactor(tradeoffFactor_[tradeoffIndex]);
       for (UnsignedInteger kernelParameterIndex = 0 ; kernelParameterIndex < kernelParameter_.getSize(); ++ kernelParameterIndex)
       {
-        driver_.setKernelParameter(kernelParameter_[kernelParameterIndex]);
-        const Scalar totalerror = driver_.runCrossValidation();
+        const Scalar totalerror = error(kernelParameterIndex * tradeoffFactor_.getSize() + tradeoffIndex, 0);
         if (totalerror < minerror)
         {
           minerror = totalerror;
@@ -131,12 +132,34 @@ UnsignedInteger SVMClassification::classify(const Point & vector) const
   return driver_.getLabel(vector);
 }
 
+Indices SVMClassification::classify(const Sample & inS) const
+{
+  return driver_.getLabel(inS);
+}
+
 
 void SVMClassification::setKernelType(const LibSVM::KernelType & kerneltype)
 {
   driver_.setKernelType(kerneltype);
 }
 
+/* Any kernel, trained through its Gram matrix */
+void SVMClassification::setKernel(const SVMKernel & kernel)
+{
+  driver_.setKernel(kernel);
+  // the kernel parameter defaults to the first parameter of the kernel
+  try
+  {
+    const Point parameter(kernel.getParameter());
+    if (parameter.getSize())
+      kernelParameter_ = Point(1, parameter[0]);
+  }
+  catch (const NotYetImplementedException &)
+  {
+    // no parameter
+  }
+}
+
 void SVMClassification::setTradeoffFactor(const Point & tradeoffFactor)
 {
   if (!tradeoffFactor.getSize())
@@ -157,6 +180,11 @@ Scalar SVMClassification::grade(const Point & inP, const UnsignedInteger outC) c
   return driver_.getLabelValues(inP, outC);
 }
 
+Point SVMClassification::grade(const Sample & inS, const Indices & outC) const
+{
+  return driver_.getLabelValues(inS, outC);
+}
+
 OT::Scalar SVMClassification::predict(const OT::Point& inP) const
 {
   return driver_.predict(inP);
@@ -214,7 +242,10 @@ void SVMClassification::runKMeans(const UnsignedInteger k)
       }
     }
     SVMClassification partial(partialSample, partialIndices);
-    partial.setKernelType(driver_.getKernelType());
+    if (driver_.getKernelType() == LibSVM::Precomputed)
+      partial.setKernel(driver_.getKernel());
+    else
+      partial.setKernelType(driver_.getKernelType());
     partial.setTradeoffFactor(tradeoffFactor_);
     partial.setKernelParameter(kernelParameter_);
     partial.run();
@@ -110,4 +110,18 @@ SymmetricMatrix SVMKernel::partialHessian(const Point & x1, const Point & x2) co
 }
 
 
+/* Gram matrix */
+SymmetricMatrix SVMKernel::computeGram(const Sample & x) const
+{
+  return getImplementation()->computeGram(x);
+}
+
+
+/* Cross-kernel matrix */
+Matrix SVMKernel::computeCrossKernel(const Sample & x1, const Sample & x2) const
+{
+  return getImplementation()->computeCrossKernel(x1, x2);
+}
+
+
 }
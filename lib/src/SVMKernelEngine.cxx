@@ -0,0 +1,627 @@
+//                                               -*- C++ -*-
+/**
+ *  @brief Kernel expansion specialized on the kernel family
+ *
+ *  Copyright 2014-2024 Phimeca
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "otsvm/SVMKernelEngine.hxx"
+#include "otsvm/SVMKernelVector.hxx"
+#include "otsvm/SVMKernelProfile.hxx"
+#include "otsvm/NormalRBF.hxx"
+#include "otsvm/ExponentialRBF.hxx"
+#include "otsvm/RationalKernel.hxx"
+#include "otsvm/PolynomialKernel.hxx"
+#include "otsvm/SigmoidKernel.hxx"
+#include "otsvm/LinearKernel.hxx"
+#include <openturns/ResourceMap.hxx>
+#include <openturns/Matrix.hxx>
+
+#include <cmath>
+#include <typeinfo>
+
+using namespace OT;
+
+namespace OTSVM
+{
+
+namespace
+{
+
+/* Largest row stride handled by the vectorized path */
+const UnsignedInteger MaximumVectorStride = 256;
+
+/* Support vectors per product of the hessian accumulation */
+const UnsignedInteger HessianBlockSize = 256;
+
+}
+
+/* Default constructor */
+SVMKernelEngine::SVMKernelEngine()
+{
+  // Nothing to do
+}
+
+/* Constructor with parameters */
+SVMKernelEngine::SVMKernelEngine(const SVMKernel & kernel,
+                                 const SupportVectorMatrix & supportVectors,
+                                 const Point & coefficients)
+  : kernel_(kernel)
+  , supportVectors_(supportVectors)
+{
+  for (UnsignedInteger j = 0; j < supportVectors.getSize(); ++ j)
+    if (coefficients[j] != 0.0)
+    {
+      active_.add(j);
+      coefficients_.add(coefficients[j]);
+    }
+
+  setFamily(*kernel.getImplementation());
+  vectorized_ = ResourceMap::GetAsBool("SVMKernel-UseVectorization")
+                && SVMKernelVector::IsAvailable()
+                && (supportVectors.getStride() <= MaximumVectorStride);
+}
+
+/* Constructor recognizing the family of a kernel */
+SVMKernelEngine::SVMKernelEngine(const SVMKernelImplementation & kernel)
+{
+  setFamily(kernel);
+}
+
+/* Recognize the built-in kernels and copy their parameters */
+void SVMKernelEngine::setFamily(const SVMKernelImplementation & implementation)
+{
+  // the exact type is required: a derived class may override the kernel
+  const std::type_info & type = typeid(implementation);
+  if (type == typeid(NormalRBF))
+  {
+    const Scalar sigma = static_cast<const NormalRBF &>(implementation).getSigma();
+    family_ = NormalRbf;
+    scale_ = 2.0 * sigma * sigma;
+  }
+  else if (type == typeid(ExponentialRBF))
+  {
+    const Scalar sigma = static_cast<const ExponentialRBF &>(implementation).getSigma();
+    family_ = ExponentialRbf;
+    scale_ = 2.0 * sigma * sigma;
+  }
+  else if (type == typeid(RationalKernel))
+  {
+    family_ = Rational;
+    constant_ = static_cast<const RationalKernel &>(implementation).getConstant();
+  }
+  else if (type == typeid(PolynomialKernel))
+  {
+    const PolynomialKernel & polynomial = static_cast<const PolynomialKernel &>(implementation);
+    family_ = Polynomial;
+    linear_ = polynomial.getLinear();
+    constant_ = polynomial.getConstant();
+    degree_ = polynomial.getDegree();
+  }
+  else if (type == typeid(SigmoidKernel))
+  {
+    const SigmoidKernel & sigmoid = static_cast<const SigmoidKernel &>(implementation);
+    family_ = Sigmoid;
+    linear_ = sigmoid.getLinear();
+    constant_ = sigmoid.getConstant();
+  }
+  else if (type == typeid(LinearKernel))
+    family_ = Linear;
+}
+
+/* Kernel family accessor */
+SVMKernelEngine::Family SVMKernelEngine::getFamily() const
+{
+  return family_;
+}
+
+/* Number of support vectors with a non-zero coefficient */
+UnsignedInteger SVMKernelEngine::getSize() const
+{
+  return active_.getSize();
+}
+
+/* Scalar loop, one support vector at a time. The radial kernels take the
+   squared distance from the explicit difference, as operator() does */
+template <class Profile>
+Scalar SVMKernelEngine::accumulateScalar(const Profile & profile, const Scalar * x,
+    const UnsignedInteger begin, const UnsignedInteger end,
+    Scalar output) const
+{
+  const UnsignedInteger dimension = supportVectors_.getDimension();
+  const UnsignedInteger stride = supportVectors_.getStride();
+  const Scalar * data = supportVectors_.data();
+  for (UnsignedInteger j = begin; j < end; ++ j)
+  {
+    const Scalar * row = data + active_[j] * stride;
+    Scalar argument = 0.0;
+    if (Profile::Type == DotProduct)
+      for (UnsignedInteger k = 0; k < dimension; ++ k)
+        argument += x[k] * row[k];
+    else
+      for (UnsignedInteger k = 0; k < dimension; ++ k)
+      {
+        const Scalar delta = x[k] - row[k];
+        argument += delta * delta;
+      }
+    output += coefficients_[j] * profile(argument);
+  }
+  return output;
+}
+
+/* Vectorized loop: the arguments and kernel values of a block of support
+   vectors are computed at once, the terms are then summed in order */
+template <class Profile>
+Scalar SVMKernelEngine::accumulateVector(const Profile & profile, const Scalar * x,
+    const UnsignedInteger begin, const UnsignedInteger end,
+    Scalar output) const
+{
+  const UnsignedInteger dimension = supportVectors_.getDimension();
+  const UnsignedInteger stride = supportVectors_.getStride();
+  const Scalar * data = supportVectors_.data();
+  alignas(64) Scalar padded[MaximumVectorStride];
+  std::copy(x, x + dimension, padded);
+  std::fill(padded + dimension, padded + stride, 0.0);
+
+  alignas(64) Scalar values[VectorBlockSize] = {};
+  for (UnsignedInteger j0 = begin; j0 < end; j0 += VectorBlockSize)
+  {
+    const UnsignedInteger n = std::min(VectorBlockSize, end - j0);
+    if (Profile::Type == DotProduct)
+      SVMKernelVector::Dots(padded, data, stride, &active_[j0], n, values);
+    else
+      SVMKernelVector::SquaredDistances(padded, data, stride, &active_[j0], n, values);
+    profile.transform(values, n);
+    for (UnsignedInteger i = 0; i < n; ++ i)
+      output += coefficients_[j0 + i] * values[i];
+  }
+  return output;
+}
+
+/* Dispatch on the vectorized or scalar loop */
+template <class Profile>
+Scalar SVMKernelEngine::accumulateProfile(const Profile & profile, const Scalar * x,
+    const UnsignedInteger begin, const UnsignedInteger end,
+    const Scalar output) const
+{
+  if (vectorized_)
+    return accumulateVector(profile, x, begin, end, output);
+  return accumulateScalar(profile, x, begin, end, output);
+}
+
+/* Fallback through the virtual kernel interface */
+Scalar SVMKernelEngine::accumulateGeneric(const Scalar * x,
+    const UnsignedInteger begin, const UnsignedInteger end,
+    Scalar output) const
+{
+  const UnsignedInteger dimension = supportVectors_.getDimension();
+  const Point point(Collection<Scalar>(x, x + dimension));
+  Point supportVector(dimension);
+  for (UnsignedInteger j = begin; j < end; ++ j)
+  {
+    const Scalar * row = supportVectors_.data(active_[j]);
+    std::copy(row, row + dimension, supportVector.begin());
+    output += coefficients_[j] * kernel_(supportVector, point);
+  }
+  return output;
+}
+
+/* Kernel values of the support vectors [begin, end), through the same
+   vectorized or scalar arguments as accumulate */
+template <class Profile>
+void SVMKernelEngine::computeProfileValues(const Profile & profile, const Scalar * x,
+    const UnsignedInteger begin, const UnsignedInteger end,
+    Scalar * values) const
+{
+  const UnsignedInteger dimension = supportVectors_.getDimension();
+  const UnsignedInteger stride = supportVectors_.getStride();
+  const Scalar * data = supportVectors_.data();
+  if (vectorized_)
+  {
+    alignas(64) Scalar padded[MaximumVectorStride];
+    std::copy(x, x + dimension, padded);
+    std::fill(padded + dimension, padded + stride, 0.0);
+    alignas(64) Scalar block[VectorBlockSize] = {};
+    for (UnsignedInteger j0 = begin; j0 < end; j0 += VectorBlockSize)
+    {
+      const UnsignedInteger n = std::min(VectorBlockSize, end - j0);
+      if (Profile::Type == DotProduct)
+        SVMKernelVector::Dots(padded, data, stride, &active_[j0], n, block);
+      else
+        SVMKernelVector::SquaredDistances(padded, data, stride, &active_[j0], n, block);
+      profile.transform(block, n);
+      std::copy(block, block + n, values + (j0 - begin));
+    }
+    return;
+  }
+  for (UnsignedInteger j = begin; j < end; ++ j)
+  {
+    const Scalar * row = data + active_[j] * stride;
+    Scalar argument = 0.0;
+    if (Profile::Type == DotProduct)
+      for (UnsignedInteger k = 0; k < dimension; ++ k)
+        argument += x[k] * row[k];
+    else
+      for (UnsignedInteger k = 0; k < dimension; ++ k)
+      {
+        const Scalar delta = x[k] - row[k];
+        argument += delta * delta;
+      }
+    values[j - begin] = profile(argument);
+  }
+}
+
+/* Kernel values through the virtual kernel interface */
+void SVMKernelEngine::computeGenericValues(const Scalar * x,
+    const UnsignedInteger begin, const UnsignedInteger end,
+    Scalar * values) const
+{
+  const UnsignedInteger dimension = supportVectors_.getDimension();
+  const Point point(Collection<Scalar>(x, x + dimension));
+  Point supportVector(dimension);
+  for (UnsignedInteger j = begin; j < end; ++ j)
+  {
+    const Scalar * row = supportVectors_.data(active_[j]);
+    std::copy(row, row + dimension, supportVector.begin());
+    values[j - begin] = kernel_(supportVector, point);
+  }
+}
+
+/* Gradient terms of the support vectors [begin, end), summed in the order
+   of computeProfileDerivatives so that both give the same gradient */
+template <class Profile>
+void SVMKernelEngine::accumulateProfileGradient(const Profile & profile, const Scalar * x,
+    const UnsignedInteger begin, const UnsignedInteger end,
+    Scalar * gradient) const
+{
+  const UnsignedInteger dimension = supportVectors_.getDimension();
+  const UnsignedInteger stride = supportVectors_.getStride();
+  const Scalar * data = supportVectors_.data();
+  const Bool radial = (Profile::Type != DotProduct);
+  for (UnsignedInteger j = begin; j < end; ++ j)
+  {
+    const Scalar * row = data + active_[j] * stride;
+    Scalar argument = 0.0;
+    if (radial)
+      for (UnsignedInteger k = 0; k < dimension; ++ k)
+      {
+        const Scalar delta = x[k] - row[k];
+        argument += delta * delta;
+      }
+    else
+      for (UnsignedInteger k = 0; k < dimension; ++ k)
+        argument += x[k] * row[k];
+
+    Scalar f = 0.0;
+    Scalar f1 = 0.0;
+    Scalar f2 = 0.0;
+    profile.derivatives(argument, f, f1, f2);
+    const Scalar alpha = (radial ? 2.0 : 1.0) * coefficients_[j] * f1;
+    if (radial)
+      for (UnsignedInteger k = 0; k < dimension; ++ k)
+        gradient[k] += alpha * (x[k] - row[k]);
+    else
+      for (UnsignedInteger k = 0; k < dimension; ++ k)
+        gradient[k] += alpha * row[k];
+  }
+}
+
+/* Gradient terms through the virtual kernel interface */
+void SVMKernelEngine::accumulateGenericGradient(const Scalar * x,
+    const UnsignedInteger begin, const UnsignedInteger end,
+    Scalar * gradient) const
+{
+  const UnsignedInteger dimension = supportVectors_.getDimension();
+  const Point point(Collection<Scalar>(x, x + dimension));
+  Point supportVector(dimension);
+  for (UnsignedInteger j = begin; j < end; ++ j)
+  {
+    const Scalar * row = supportVectors_.data(active_[j]);
+    std::copy(row, row + dimension, supportVector.begin());
+    const Point partialGradient(kernel_.partialGradient(point, supportVector));
+    for (UnsignedInteger k = 0; k < dimension; ++ k)
+      gradient[k] += coefficients_[j] * partialGradient[k];
+  }
+}
+
+/* Single pass over the support vectors for the value and derivatives.
+   The hessian sum_j beta_j u_j u_j^T, plus sum_j alpha_j I for the radial
+   kernels, is accumulated by blocks of support vectors as the product
+   U^T (diag(beta) U), without any temporary per support vector */
+template <class Profile>
+void SVMKernelEngine::computeProfileDerivatives(const Profile & profile, const Scalar * x,
+    Scalar & value, Scalar * gradient, Scalar * hessian) const
+{
+  const UnsignedInteger dimension = supportVectors_.getDimension();
+  const UnsignedInteger stride = supportVectors_.getStride();
+  const UnsignedInteger activeNumber = active_.getSize();
+  const Scalar * data = supportVectors_.data();
+  const Bool radial = (Profile::Type != DotProduct);
+  const UnsignedInteger blockSize = std::min(HessianBlockSize, activeNumber);
+
+  // the directions u_j and the weighted directions beta_j u_j of a block, column-major
+  Matrix directions;
+  Matrix weightedDirections;
+  Scalar * directionData = nullptr;
+  Scalar * weightedData = nullptr;
+  if (hessian && (blockSize > 0))
+  {
+    directions = Matrix(blockSize, dimension);
+    weightedDirections = Matrix(blockSize, dimension);
+    directionData = &directions(0, 0);
+    weightedData = &weightedDirections(0, 0);
+  }
+
+  Point difference(dimension);
+  Scalar diagonal = 0.0;
+  for (UnsignedInteger j0 = 0; j0 < activeNumber; j0 += HessianBlockSize)
+  {
+    const UnsignedInteger j1 = std::min(j0 + HessianBlockSize, activeNumber);
+    for (UnsignedInteger j = j0; j < j1; ++ j)
+    {
+      const Scalar * row = data + active_[j] * stride;
+      const Scalar * direction = row;
+      Scalar argument = 0.0;
+      if (radial)
+      {
+        for (UnsignedInteger k = 0; k < dimension; ++ k)
+        {
+          difference[k] = x[k] - row[k];
+          argument += difference[k] * difference[k];
+        }
+        direction = &difference[0];
+      }
+      else
+        for (UnsignedInteger k = 0; k < dimension; ++ k)
+          argument += x[k] * row[k];
+
+      Scalar f = 0.0;
+      Scalar f1 = 0.0;
+      Scalar f2 = 0.0;
+      profile.derivatives(argument, f, f1, f2);
+      value += coefficients_[j] * f;
+      const Scalar alpha = (radial ? 2.0 : 1.0) * coefficients_[j] * f1;
+      for (UnsignedInteger k = 0; k < dimension; ++ k)
+        gradient[k] += alpha * direction[k];
+      if (hessian)
+      {
+        const Scalar beta = (radial ? 4.0 : 1.0) * coefficients_[j] * f2;
+        if (radial)
+          diagonal += alpha;
+        for (UnsignedInteger k = 0; k < dimension; ++ k)
+        {
+          directionData[(j - j0) + k * blockSize] = direction[k];
+          weightedData[(j - j0) + k * blockSize] = beta * direction[k];
+        }
+      }
+    }
+    if (hessian)
+    {
+      // the rows left over by a shorter last block must not contribute
+      for (UnsignedInteger j = j1 - j0; j < blockSize; ++ j)
+        for (UnsignedInteger k = 0; k < dimension; ++ k)
+          weightedData[j + k * blockSize] = 0.0;
+      const Matrix product(directions.getImplementation()->genProd(*weightedDirections.getImplementation(), true, false));
+      for (UnsignedInteger k = 0; k < dimension; ++ k)
+        for (UnsignedInteger l = 0; l <= k; ++ l)
+          hessian[k * dimension + l] += product(k, l);
+    }
+  }
+  if (hessian)
+    for (UnsignedInteger k = 0; k < dimension; ++ k)
+      hessian[k * dimension + k] += diagonal;
+}
+
+/* Derivatives through the virtual kernel interface */
+void SVMKernelEngine::computeGenericDerivatives(const Scalar * x,
+    Scalar & value, Scalar * gradient, Scalar * hessian) const
+{
+  const UnsignedInteger dimension = supportVectors_.getDimension();
+  const Point point(Collection<Scalar>(x, x + dimension));
+  Point supportVector(dimension);
+  for (UnsignedInteger j = 0; j < active_.getSize(); ++ j)
+  {
+    const Scalar * row = supportVectors_.data(active_[j]);
+    std::copy(row, row + dimension, supportVector.begin());
+    value += coefficients_[j] * kernel_(supportVector, point);
+    const Point partialGradient(kernel_.partialGradient(point, supportVector));
+    for (UnsignedInteger k = 0; k < dimension; ++ k)
+      gradient[k] += coefficients_[j] * partialGradient[k];
+    if (hessian)
+    {
+      const SymmetricMatrix partialHessian(kernel_.partialHessian(point, supportVector));
+      for (UnsignedInteger k = 0; k < dimension; ++ k)
+        for (UnsignedInteger l = 0; l <= k; ++ l)
+          hessian[k * dimension + l] += coefficients_[j] * partialHessian(k, l);
+    }
+  }
+}
+
+/* Value, gradient and optionally hessian of the expansion at x */
+void SVMKernelEngine::computeDerivatives(const Scalar * x,
+    Scalar & value, Scalar * gradient, Scalar * hessian) const
+{
+  switch (family_)
+  {
+    case NormalRbf:
+      computeProfileDerivatives(NormalRBFProfile({scale_}), x, value, gradient, hessian);
+      break;
+    case ExponentialRbf:
+      computeProfileDerivatives(ExponentialRBFProfile({scale_}), x, value, gradient, hessian);
+      break;
+    case Rational:
+      computeProfileDerivatives(RationalProfile({constant_}), x, value, gradient, hessian);
+      break;
+    case Polynomial:
+      computeProfileDerivatives(PolynomialProfile({linear_, constant_, degree_}), x, value, gradient, hessian);
+      break;
+    case Sigmoid:
+      computeProfileDerivatives(SigmoidProfile({linear_, constant_}), x, value, gradient, hessian);
+      break;
+    case Linear:
+      computeProfileDerivatives(LinearProfile(), x, value, gradient, hessian);
+      break;
+    default:
+      computeGenericDerivatives(x, value, gradient, hessian);
+  }
+}
+
+/* Kernel values of the active support vectors [begin, end) at x */
+void SVMKernelEngine::computeKernelValues(const Scalar * x,
+    const UnsignedInteger begin,
+    const UnsignedInteger end,
+    Scalar * values) const
+{
+  switch (family_)
+  {
+    case NormalRbf:
+      computeProfileValues(NormalRBFProfile({scale_}), x, begin, end, values);
+      break;
+    case ExponentialRbf:
+      computeProfileValues(ExponentialRBFProfile({scale_}), x, begin, end, values);
+      break;
+    case Rational:
+      computeProfileValues(RationalProfile({constant_}), x, begin, end, values);
+      break;
+    case Polynomial:
+      computeProfileValues(PolynomialProfile({linear_, constant_, degree_}), x, begin, end, values);
+      break;
+    case Sigmoid:
+      computeProfileValues(SigmoidProfile({linear_, constant_}), x, begin, end, values);
+      break;
+    case Linear:
+      computeProfileValues(LinearProfile(), x, begin, end, values);
+      break;
+    default:
+      computeGenericValues(x, begin, end, values);
+  }
+}
+
+/* Add the gradients of the terms [begin, end) of the expansion at x */
+void SVMKernelEngine::accumulateGradient(const Scalar * x,
+    const UnsignedInteger begin,
+    const UnsignedInteger end,
+    Scalar * gradient) const
+{
+  switch (family_)
+  {
+    case NormalRbf:
+      accumulateProfileGradient(NormalRBFProfile({scale_}), x, begin, end, gradient);
+      break;
+    case ExponentialRbf:
+      accumulateProfileGradient(ExponentialRBFProfile({scale_}), x, begin, end, gradient);
+      break;
+    case Rational:
+      accumulateProfileGradient(RationalProfile({constant_}), x, begin, end, gradient);
+      break;
+    case Polynomial:
+      accumulateProfileGradient(PolynomialProfile({linear_, constant_, degree_}), x, begin, end, gradient);
+      break;
+    case Sigmoid:
+      accumulateProfileGradient(SigmoidProfile({linear_, constant_}), x, begin, end, gradient);
+      break;
+    case Linear:
+      accumulateProfileGradient(LinearProfile(), x, begin, end, gradient);
+      break;
+    default:
+      accumulateGenericGradient(x, begin, end, gradient);
+  }
+}
+
+/* Gram matrix of a built-in family */
+Bool SVMKernelEngine::computeGram(const Sample & x, SymmetricMatrix & gram) const
+{
+  switch (family_)
+  {
+    case NormalRbf:
+      gram = ComputeProfileGram(NormalRBFProfile({scale_}), x);
+      return true;
+    case ExponentialRbf:
+      gram = ComputeProfileGram(ExponentialRBFProfile({scale_}), x);
+      return true;
+    case Rational:
+      gram = ComputeProfileGram(RationalProfile({constant_}), x);
+      return true;
+    case Polynomial:
+      gram = ComputeProfileGram(PolynomialProfile({linear_, constant_, degree_}), x);
+      return true;
+    case Sigmoid:
+      gram = ComputeProfileGram(SigmoidProfile({linear_, constant_}), x);
+      return true;
+    case Linear:
+      gram = ComputeProfileGram(LinearProfile(), x);
+      return true;
+    default:
+      return false;
+  }
+}
+
+/* Cross-kernel matrix of a built-in family */
+Bool SVMKernelEngine::computeCrossKernel(const Sample & x1, const Sample & x2, Matrix & crossKernel) const
+{
+  switch (family_)
+  {
+    case NormalRbf:
+      crossKernel = ComputeProfileCrossKernel(NormalRBFProfile({scale_}), x1, x2);
+      return true;
+    case ExponentialRbf:
+      crossKernel = ComputeProfileCrossKernel(ExponentialRBFProfile({scale_}), x1, x2);
+      return true;
+    case Rational:
+      crossKernel = ComputeProfileCrossKernel(RationalProfile({constant_}), x1, x2);
+      return true;
+    case Polynomial:
+      crossKernel = ComputeProfileCrossKernel(PolynomialProfile({linear_, constant_, degree_}), x1, x2);
+      return true;
+    case Sigmoid:
+      crossKernel = ComputeProfileCrossKernel(SigmoidProfile({linear_, constant_}), x1, x2);
+      return true;
+    case Linear:
+      crossKernel = ComputeProfileCrossKernel(LinearProfile(), x1, x2);
+      return true;
+    default:
+      return false;
+  }
+}
+
+/* Add the terms [begin, end) of the expansion at x to output */
+Scalar SVMKernelEngine::accumulate(const Scalar * x,
+                                   const UnsignedInteger begin,
+                                   const UnsignedInteger end,
+                                   const Scalar output) const
+{
+  switch (family_)
+  {
+    case NormalRbf:
+      return accumulateProfile(NormalRBFProfile({scale_}), x, begin, end, output);
+    case ExponentialRbf:
+      return accumulateProfile(ExponentialRBFProfile({scale_}), x, begin, end, output);
+    case Rational:
+      return accumulateProfile(RationalProfile({constant_}), x, begin, end, output);
+    case Polynomial:
+      return accumulateProfile(PolynomialProfile({linear_, constant_, degree_}), x, begin, end, output);
+    case Sigmoid:
+      return accumulateProfile(SigmoidProfile({linear_, constant_}), x, begin, end, output);
+    case Linear:
+      return accumulateProfile(LinearProfile(), x, begin, end, output);
+    default:
+      return accumulateGeneric(x, begin, end, output);
+  }
+}
+
+
+}
@@ -19,7 +19,9 @@
  *
  */
 #include "otsvm/SVMKernelImplementation.hxx"
+#include "otsvm/SVMKernelEngine.hxx"
 #include <openturns/Exception.hxx>
+#include <openturns/TBBImplementation.hxx>
 
 using namespace OT;
 
@@ -90,6 +92,78 @@ SymmetricMatrix SVMKernelImplementation::partialHessian(const Point & /*x*/, con
   throw NotYetImplementedException(HERE) << "SVMKernelImplementation::partialHessian";
 }
 
+/* Kernel values of the pairs (x1_i, x2_j), i >= first(j), over a range of columns */
+namespace
+{
+struct SVMKernelImplementationPolicy
+{
+  const SVMKernelImplementation & kernel_;
+  const Sample & x1_;
+  const Sample & x2_;
+  const Bool lowerOnly_;
+  Scalar * values_;
+
+  SVMKernelImplementationPolicy(const SVMKernelImplementation & kernel,
+                                const Sample & x1,
+                                const Sample & x2,
+                                const Bool lowerOnly,
+                                Scalar * values)
+    : kernel_(kernel)
+    , x1_(x1)
+    , x2_(x2)
+    , lowerOnly_(lowerOnly)
+    , values_(values)
+  {
+    // Nothing to do
+  }
+
+  inline void operator()(const TBBImplementation::BlockedRange<UnsignedInteger> & r) const
+  {
+    const UnsignedInteger size1 = x1_.getSize();
+    for (UnsignedInteger j = r.begin(); j != r.end(); ++ j)
+    {
+      const Point x2j(x2_[j]);
+      for (UnsignedInteger i = (lowerOnly_ ? j : 0); i < size1; ++ i)
+        values_[i + j * size1] = kernel_(x1_[i], x2j);
+    }
+  }
+}; /* end struct SVMKernelImplementationPolicy */
+}
+
+/* Gram matrix, by parallel loops over the pairs of the lower triangle */
+SymmetricMatrix SVMKernelImplementation::computeGram(const Sample & x) const
+{
+  // the built-in kernels, but not their derived classes, have specialized loops
+  SymmetricMatrix result;
+  if (SVMKernelEngine(*this).computeGram(x, result))
+    return result;
+  const UnsignedInteger size = x.getSize();
+  result = SymmetricMatrix(size);
+  if (size == 0)
+    return result;
+  const SVMKernelImplementationPolicy policy(*this, x, x, true, &result(0, 0));
+  TBBImplementation::ParallelFor(0, size, policy);
+  return result;
+}
+
+/* Cross-kernel matrix, by parallel loops over the pairs */
+Matrix SVMKernelImplementation::computeCrossKernel(const Sample & x1, const Sample & x2) const
+{
+  if (x1.getDimension() != x2.getDimension())
+    throw InvalidArgumentException(HERE) << "The samples must have the same dimension, here " << x1.getDimension() << " and " << x2.getDimension();
+  Matrix result;
+  if (SVMKernelEngine(*this).computeCrossKernel(x1, x2, result))
+    return result;
+  const UnsignedInteger size1 = x1.getSize();
+  const UnsignedInteger size2 = x2.getSize();
+  result = Matrix(size1, size2);
+  if ((size1 == 0) || (size2 == 0))
+    return result;
+  const SVMKernelImplementationPolicy policy(*this, x1, x2, false, &result(0, 0));
+  TBBImplementation::ParallelFor(0, size2, policy);
+  return result;
+}
+
 /* Method save() stores the object through the StorageManager */
 void SVMKernelImplementation::save(Advocate & adv) const
 {
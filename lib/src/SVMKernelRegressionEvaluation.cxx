@@ -20,7 +20,10 @@
  */
 
 #include "otsvm/SVMKernelRegressionEvaluation.hxx"
+#include "otsvm/SVMKernelEngine.hxx"
 #include <openturns/PersistentObjectFactory.hxx>
+#include <openturns/ResourceMap.hxx>
+#include <openturns/TBBImplementation.hxx>
 
 using namespace OT;
 
@@ -31,9 +34,15 @@ CLASSNAMEINIT(SVMKernelRegressionEvaluation)
 
 static Factory<SVMKernelRegressionEvaluation> Factory_SVMKernelRegressionEvaluation;
 
+/* Tile sizes of the batch evaluation: a block of input points is swept
+   against a block of support vectors so that both stay in cache */
+static const UnsignedInteger InputBlockSize = 64;
+static const UnsignedInteger SupportVectorBlockSize = 256;
+
 /* Default constructor */
 SVMKernelRegressionEvaluation::SVMKernelRegressionEvaluation()
 : EvaluationImplementation()
+, p_engine_(new SVMKernelEngine)
 {
   // Nothing to do
 }
@@ -41,13 +50,14 @@ SVMKernelRegressionEvaluation::SVMKernelRegressionEvaluation()
 /* Constructor with parameters */
 SVMKernelRegressionEvaluation::SVMKernelRegressionEvaluation(const SVMKernel & kernel,
     const Point & lagrangeMultiplier,
-    const Sample & dataIn,
+    const SupportVectorMatrix & supportVectors,
     const Scalar constant)
 : EvaluationImplementation()
 , kernel_(kernel)
 , lagrangeMultiplier_(lagrangeMultiplier)
-, dataIn_(dataIn)
+, supportVectors_(supportVectors)
 , constant_(constant)
+, p_engine_(new SVMKernelEngine(kernel, supportVectors, lagrangeMultiplier))
 {
   // Nothing to do
 }
@@ -62,7 +72,7 @@ SVMKernelRegressionEvaluation * SVMKernelRegressionEvaluation::clone() const
 Bool SVMKernelRegressionEvaluation::operator==(const SVMKernelRegressionEvaluation & other) const
 {
   if (this == &other) return true;
-  return (kernel_ == other.kernel_) && (lagrangeMultiplier_ == other.lagrangeMultiplier_) && (constant_ == other.constant_) && (dataIn_ == other.dataIn_);
+  return (kernel_ == other.kernel_) && (lagrangeMultiplier_ == other.lagrangeMultiplier_) && (constant_ == other.constant_) && (supportVectors_ == other.supportVectors_);
 }
 
 /* String converter */
@@ -72,7 +82,7 @@ String SVMKernelRegressionEvaluation::__repr__() const
   oss << "class=" << SVMKernelRegressionEvaluation::GetClassName()
       << " kernel=" << kernel_
       << " lagrange multipliers=" << lagrangeMultiplier_
-      << " data in=" << dataIn_
+      << " support vectors=" << supportVectors_
       << " constant=" << constant_;
 
   return oss;
@@ -84,24 +94,129 @@ Point SVMKernelRegressionEvaluation::operator() (const Point & inP) const
   callsNumber_.increment();
 
   const UnsignedInteger dimension(inP.getDimension());
-  if (dimension != dataIn_.getDimension())
+  if (dimension != supportVectors_.getDimension())
+    throw InvalidArgumentException(HERE) << "Invalid input dimension";
+
+  // compute the sum of the kernel evaluation over the support vectors
+  const Scalar output = p_engine_->accumulate(&inP[0], 0, p_engine_->getSize(), constant_);
+  return Point(1, output);
+}
+
+/* Value and gradient in a single pass over the support vectors */
+Point SVMKernelRegressionEvaluation::computeValueAndGradient(const Point & inP,
+    Matrix & gradient) const
+{
+  const UnsignedInteger dimension = inP.getDimension();
+  if (dimension != supportVectors_.getDimension())
+    throw InvalidArgumentException(HERE) << "Invalid input dimension";
+  callsNumber_.increment();
+
+  Scalar value = constant_;
+  gradient = Matrix(dimension, 1);
+  p_engine_->computeDerivatives(&inP[0], value, &gradient(0, 0), nullptr);
+  return Point(1, value);
+}
+
+/* Value, gradient and hessian in a single pass over the support vectors */
+Point SVMKernelRegressionEvaluation::computeValueAndDerivatives(const Point & inP,
+    Matrix & gradient,
+    SymmetricTensor & hessian) const
+{
+  const UnsignedInteger dimension = inP.getDimension();
+  if (dimension != supportVectors_.getDimension())
     throw InvalidArgumentException(HERE) << "Invalid input dimension";
+  callsNumber_.increment();
+
+  Scalar value = constant_;
+  gradient = Matrix(dimension, 1);
+  Point lowerHessian(dimension * dimension);
+  p_engine_->computeDerivatives(&inP[0], value, &gradient(0, 0), &lowerHessian[0]);
+  hessian = SymmetricTensor(dimension, 1);
+  for (UnsignedInteger i = 0; i < dimension; ++ i)
+    for (UnsignedInteger j = 0; j <= i; ++ j)
+      hessian(i, j, 0) = lowerHessian[i * dimension + j];
+  return Point(1, value);
+}
 
-  // compute the sum of the kernel evaluation over the data
-  Scalar output(constant_);
-  UnsignedInteger size(dataIn_.getSize());
-  for (UnsignedInteger i = 0; i < size; ++ i)
+/* Evaluation of contiguous chunks of input rows.
+   Each row sums its terms in the order of the point-wise evaluation
+   whatever the chunk it belongs to, so the result does not depend on the
+   number of threads */
+namespace
+{
+struct SVMKernelRegressionEvaluationPolicy
+{
+  const SVMKernelEngine & engine_;
+  const Sample & input_;
+  Scalar * output_;
+  const UnsignedInteger chunkSize_;
+
+  SVMKernelRegressionEvaluationPolicy(const SVMKernelEngine & engine,
+                                      const Sample & input,
+                                      Scalar * output,
+                                      const UnsignedInteger chunkSize)
+    : engine_(engine)
+    , input_(input)
+    , output_(output)
+    , chunkSize_(chunkSize)
   {
-    if (lagrangeMultiplier_[i] != 0.0)
-      output += lagrangeMultiplier_[i] * kernel_(dataIn_[i], inP);
+    // Nothing to do
   }
-  return Point(1, output);
+
+  inline void operator()(const TBBImplementation::BlockedRange<UnsignedInteger> & r) const
+  {
+    const UnsignedInteger size = input_.getSize();
+    const UnsignedInteger supportVectorNumber = engine_.getSize();
+    for (UnsignedInteger chunk = r.begin(); chunk != r.end(); ++ chunk)
+    {
+      const UnsignedInteger end = std::min((chunk + 1) * chunkSize_, size);
+      for (UnsignedInteger i0 = chunk * chunkSize_; i0 < end; i0 += InputBlockSize)
+      {
+        const UnsignedInteger i1 = std::min(i0 + InputBlockSize, end);
+        for (UnsignedInteger j0 = 0; j0 < supportVectorNumber; j0 += SupportVectorBlockSize)
+        {
+          const UnsignedInteger j1 = std::min(j0 + SupportVectorBlockSize, supportVectorNumber);
+          for (UnsignedInteger i = i0; i < i1; ++ i)
+            output_[i] = engine_.accumulate(&input_(i, 0), j0, j1, output_[i]);
+        }
+      }
+    }
+  }
+}; /* end struct SVMKernelRegressionEvaluationPolicy */
+}
+
+/* Operator () over a sample */
+Sample SVMKernelRegressionEvaluation::operator() (const Sample & inS) const
+{
+  const UnsignedInteger dimension = inS.getDimension();
+  if (dimension != supportVectors_.getDimension())
+    throw InvalidArgumentException(HERE) << "Invalid input dimension";
+  const UnsignedInteger size = inS.getSize();
+  callsNumber_.fetchAndAdd(size);
+
+  // split the rows in at most one chunk per thread, made of whole input blocks
+  UnsignedInteger threadNumber = ResourceMap::GetAsUnsignedInteger("SVMRegression-PredictionThreads");
+  if (threadNumber == 0)
+    threadNumber = TBBImplementation::GetNumberOfThreads();
+  const UnsignedInteger blockNumber = (size + InputBlockSize - 1) / InputBlockSize;
+  const UnsignedInteger chunkNumber = std::max<UnsignedInteger>(1, std::min(threadNumber, blockNumber));
+  const UnsignedInteger chunkSize = ((blockNumber + chunkNumber - 1) / chunkNumber) * InputBlockSize;
+
+  // the rows of the output sample accumulate the expansion in place
+  Sample outS(size, Point(1, constant_));
+  const SVMKernelRegressionEvaluationPolicy policy(*p_engine_, inS, size > 0 ? &outS(0, 0) : nullptr, chunkSize);
+  if (chunkNumber == 1)
+    policy(TBBImplementation::BlockedRange<UnsignedInteger>(0, 1));
+  else
+    TBBImplementation::ParallelFor(0, chunkNumber, policy);
+  outS.setDescription(getOutputDescription());
+  return outS;
 }
 
 /* Accessor for input point dimension */
 UnsignedInteger SVMKernelRegressionEvaluation::getInputDimension() const
 {
-  return dataIn_.getDimension();
+  return supportVectors_.getDimension();
 }
 
 /* Accessor for output point dimension */
@@ -116,7 +231,7 @@ void SVMKernelRegressionEvaluation::save(Advocate & adv) const
   EvaluationImplementation::save(adv);
   adv.saveAttribute("kernel_", kernel_);
   adv.saveAttribute("lagrangeMultiplier_", lagrangeMultiplier_);
-  adv.saveAttribute("dataIn_", dataIn_);
+  adv.saveAttribute("supportVectors_", supportVectors_);
   adv.saveAttribute("constant_", constant_);
 }
 
@@ -126,8 +241,17 @@ void SVMKernelRegressionEvaluation::load(Advocate & adv)
   EvaluationImplementation::load(adv);
   adv.loadAttribute("kernel_", kernel_);
   adv.loadAttribute("lagrangeMultiplier_", lagrangeMultiplier_);
-  adv.loadAttribute("dataIn_", dataIn_);
+  if (adv.hasAttribute("supportVectors_"))
+    adv.loadAttribute("supportVectors_", supportVectors_);
+  else
+  {
+    // studies saved before the packed storage hold the raw sample
+    Sample dataIn;
+    adv.loadAttribute("dataIn_", dataIn);
+    supportVectors_ = SupportVectorMatrix(dataIn);
+  }
   adv.loadAttribute("constant_", constant_);
+  p_engine_ = new SVMKernelEngine(kernel_, supportVectors_, lagrangeMultiplier_);
 }
 
 
@@ -20,7 +20,10 @@
  */
 
 #include "otsvm/SVMKernelRegressionGradient.hxx"
+#include "otsvm/SVMKernelEngine.hxx"
 #include <openturns/PersistentObjectFactory.hxx>
+#include <openturns/ResourceMap.hxx>
+#include <openturns/TBBImplementation.hxx>
 
 using namespace OT;
 
@@ -30,10 +33,15 @@ namespace OTSVM
 CLASSNAMEINIT(SVMKernelRegressionGradient)
 static Factory<SVMKernelRegressionGradient> Factory_SVMKernelRegressionGradient;
 
+/* Tile sizes of the batch gradient, as for the batch evaluation */
+static const UnsignedInteger InputBlockSize = 64;
+static const UnsignedInteger SupportVectorBlockSize = 256;
+
 
 /* Default constructor */
 SVMKernelRegressionGradient::SVMKernelRegressionGradient()
 : GradientImplementation()
+, p_engine_(new SVMKernelEngine)
 {
   // Nothing to do
 }
@@ -42,13 +50,14 @@ SVMKernelRegressionGradient::SVMKernelRegressionGradient()
 /* Constructor with parameters */
 SVMKernelRegressionGradient::SVMKernelRegressionGradient(const SVMKernel & kernel,
     const Point & lagrangeMultiplier,
-    const Sample & dataIn,
+    const SupportVectorMatrix & supportVectors,
     const Scalar constant)
 : GradientImplementation()
 , kernel_(kernel)
 , lagrangeMultiplier_(lagrangeMultiplier)
-, dataIn_(dataIn)
+, supportVectors_(supportVectors)
 , constant_(constant)
+, p_engine_(new SVMKernelEngine(kernel, supportVectors, lagrangeMultiplier))
 {
   // Nothing to do
 }
@@ -64,7 +73,7 @@ SVMKernelRegressionGradient * SVMKernelRegressionGradient::clone() const
 Bool SVMKernelRegressionGradient::operator==(const SVMKernelRegressionGradient & other) const
 {
   if (this == &other) return true;
-  return (kernel_ == other.kernel_) && (lagrangeMultiplier_ == other.lagrangeMultiplier_) && (constant_ == other.constant_) && (dataIn_ == other.dataIn_);
+  return (kernel_ == other.kernel_) && (lagrangeMultiplier_ == other.lagrangeMultiplier_) && (constant_ == other.constant_) && (supportVectors_ == other.supportVectors_);
 }
 
 /* String converter */
@@ -74,7 +83,7 @@ String SVMKernelRegressionGradient::__repr__() const
   oss << "class=" << SVMKernelRegressionGradient::GetClassName()
       << " kernel=" << kernel_
       << " lagrange multipliers=" << lagrangeMultiplier_
-      << " data in=" << dataIn_
+      << " support vectors=" << supportVectors_
       << " constant=" << constant_;
   return oss;
 }
@@ -85,31 +94,94 @@ Matrix SVMKernelRegressionGradient::gradient(const Point & inP) const
   callsNumber_.increment();
 
   const UnsignedInteger dimension = inP.getDimension();
-  if(dimension != dataIn_.getDimension())
+  if(dimension != supportVectors_.getDimension())
     throw InvalidArgumentException(HERE) << "Invalid input dimension";
 
-  // compute the sum of the partial gradients
-  const UnsignedInteger size = dataIn_.getSize();
-  Point partialGradient(dimension, 0.0);
-  for(UnsignedInteger i = 0; i < size; ++ i)
+  // sum the partial gradients, each kernel being computed once per support vector
+  Scalar value = 0.0;
+  Matrix result(dimension, 1);
+  p_engine_->computeDerivatives(&inP[0], value, &result(0, 0), nullptr);
+  return result;
+}
+
+/* Gradients of contiguous chunks of input rows.
+   Each row sums its terms in the order of the point-wise gradient, so the
+   result depends neither on the tiles nor on the number of threads */
+namespace
+{
+struct SVMKernelRegressionGradientPolicy
+{
+  const SVMKernelEngine & engine_;
+  const Sample & input_;
+  Scalar * output_;
+  const UnsignedInteger chunkSize_;
+
+  SVMKernelRegressionGradientPolicy(const SVMKernelEngine & engine,
+                                    const Sample & input,
+                                    Scalar * output,
+                                    const UnsignedInteger chunkSize)
+    : engine_(engine)
+    , input_(input)
+    , output_(output)
+    , chunkSize_(chunkSize)
   {
-    if(lagrangeMultiplier_[i] != 0.0)
-      partialGradient += lagrangeMultiplier_[i] * kernel_.partialGradient(inP, dataIn_[i]);
+    // Nothing to do
   }
 
-  // return the gradient into a column Matrix
-  Matrix result(dimension, 1);
-  for(UnsignedInteger i = 0; i < dimension; ++ i)
+  inline void operator()(const TBBImplementation::BlockedRange<UnsignedInteger> & r) const
   {
-    result(i, 0) = partialGradient[i];
+    const UnsignedInteger size = input_.getSize();
+    const UnsignedInteger dimension = input_.getDimension();
+    const UnsignedInteger supportVectorNumber = engine_.getSize();
+    for (UnsignedInteger chunk = r.begin(); chunk != r.end(); ++ chunk)
+    {
+      const UnsignedInteger end = std::min((chunk + 1) * chunkSize_, size);
+      for (UnsignedInteger i0 = chunk * chunkSize_; i0 < end; i0 += InputBlockSize)
+      {
+        const UnsignedInteger i1 = std::min(i0 + InputBlockSize, end);
+        for (UnsignedInteger j0 = 0; j0 < supportVectorNumber; j0 += SupportVectorBlockSize)
+        {
+          const UnsignedInteger j1 = std::min(j0 + SupportVectorBlockSize, supportVectorNumber);
+          for (UnsignedInteger i = i0; i < i1; ++ i)
+            engine_.accumulateGradient(&input_(i, 0), j0, j1, output_ + i * dimension);
+        }
+      }
+    }
   }
+}; /* end struct SVMKernelRegressionGradientPolicy */
+}
+
+/* Gradients over a sample */
+Sample SVMKernelRegressionGradient::gradient(const Sample & inS) const
+{
+  const UnsignedInteger dimension = inS.getDimension();
+  if (dimension != supportVectors_.getDimension())
+    throw InvalidArgumentException(HERE) << "Invalid input dimension";
+  const UnsignedInteger size = inS.getSize();
+  callsNumber_.fetchAndAdd(size);
+
+  // split the rows in at most one chunk per thread, made of whole input blocks
+  UnsignedInteger threadNumber = ResourceMap::GetAsUnsignedInteger("SVMRegression-PredictionThreads");
+  if (threadNumber == 0)
+    threadNumber = TBBImplementation::GetNumberOfThreads();
+  const UnsignedInteger blockNumber = (size + InputBlockSize - 1) / InputBlockSize;
+  const UnsignedInteger chunkNumber = std::max<UnsignedInteger>(1, std::min(threadNumber, blockNumber));
+  const UnsignedInteger chunkSize = ((blockNumber + chunkNumber - 1) / chunkNumber) * InputBlockSize;
+
+  // the gradients are accumulated contiguously, one row per input point
+  Sample result(size, dimension);
+  const SVMKernelRegressionGradientPolicy policy(*p_engine_, inS, size > 0 ? &result(0, 0) : nullptr, chunkSize);
+  if (chunkNumber == 1)
+    policy(TBBImplementation::BlockedRange<UnsignedInteger>(0, 1));
+  else
+    TBBImplementation::ParallelFor(0, chunkNumber, policy);
   return result;
 }
 
 /* Accessor for input point dimension */
 UnsignedInteger SVMKernelRegressionGradient::getInputDimension() const
 {
-  return dataIn_.getDimension();
+  return supportVectors_.getDimension();
 }
 
 /* Accessor for output point dimension */
@@ -124,7 +196,7 @@ void SVMKernelRegressionGradient::save(Advocate & adv) const
   GradientImplementation::save(adv);
   adv.saveAttribute("kernel_", kernel_);
   adv.saveAttribute("lagrangeMultiplier_", lagrangeMultiplier_);
-  adv.saveAttribute("dataIn_", dataIn_);
+  adv.saveAttribute("supportVectors_", supportVectors_);
   adv.saveAttribute("constant_", constant_);
 }
 
@@ -134,8 +206,17 @@ void SVMKernelRegressionGradient::load(Advocate & adv)
   GradientImplementation::load(adv);
   adv.loadAttribute("kernel_", kernel_);
   adv.loadAttribute("lagrangeMultiplier_", lagrangeMultiplier_);
-  adv.loadAttribute("dataIn_", dataIn_);
+  if (adv.hasAttribute("supportVectors_"))
+    adv.loadAttribute("supportVectors_", supportVectors_);
+  else
+  {
+    // studies saved before the packed storage hold the raw sample
+    Sample dataIn;
+    adv.loadAttribute("dataIn_", dataIn);
+    supportVectors_ = SupportVectorMatrix(dataIn);
+  }
   adv.loadAttribute("constant_", constant_);
+  p_engine_ = new SVMKernelEngine(kernel_, supportVectors_, lagrangeMultiplier_);
 }
 
 
@@ -20,6 +20,7 @@
  */
 
 #include "otsvm/SVMKernelRegressionHessian.hxx"
+#include "otsvm/SVMKernelEngine.hxx"
 #include <openturns/PersistentObjectFactory.hxx>
 
 using namespace OT;
@@ -34,6 +35,7 @@ static Factory<SVMKernelRegressionHessian> Factory_SVMKernelRegressionHessian;
 /* Default constructor */
 SVMKernelRegressionHessian::SVMKernelRegressionHessian()
 : HessianImplementation()
+, p_engine_(new SVMKernelEngine)
 {
   // Nothing to do
 }
@@ -42,13 +44,14 @@ SVMKernelRegressionHessian::SVMKernelRegressionHessian()
 /* Constructor with parameters */
 SVMKernelRegressionHessian::SVMKernelRegressionHessian(const SVMKernel & kernel,
     const Point & lagrangeMultiplier,
-    const Sample & dataIn,
+    const SupportVectorMatrix & supportVectors,
     const Scalar constant)
 : HessianImplementation()
 , kernel_(kernel)
 , lagrangeMultiplier_(lagrangeMultiplier)
-, dataIn_(dataIn)
+, supportVectors_(supportVectors)
 , constant_(constant)
+, p_engine_(new SVMKernelEngine(kernel, supportVectors, lagrangeMultiplier))
 {
   // Nothing to do
 }
@@ -63,7 +66,7 @@ SVMKernelRegressionHessian * SVMKernelRegressionHessian::clone() const
 Bool SVMKernelRegressionHessian::operator==(const SVMKernelRegressionHessian & other) const
 {
   if (this == &other) return true;
-  return (kernel_ == other.kernel_) && (lagrangeMultiplier_ == other.lagrangeMultiplier_) && (constant_ == other.constant_) && (dataIn_ == other.dataIn_);
+  return (kernel_ == other.kernel_) && (lagrangeMultiplier_ == other.lagrangeMultiplier_) && (constant_ == other.constant_) && (supportVectors_ == other.supportVectors_);
 }
 
 /* String converter */
@@ -73,7 +76,7 @@ String SVMKernelRegressionHessian::__repr__() const
   oss << "class=" << SVMKernelRegressionHessian::GetClassName()
       << " kernel=" << kernel_
       << " lagrange multipliers=" << lagrangeMultiplier_
-      << " data in=" << dataIn_
+      << " support vectors=" << supportVectors_
       << " constant=" << constant_;
   return oss;
 }
@@ -84,21 +87,20 @@ SymmetricTensor SVMKernelRegressionHessian::hessian(const Point & inP) const
   callsNumber_.increment();
 
   const UnsignedInteger dimension = inP.getDimension();
-  if(dimension != dataIn_.getDimension())
+  if(dimension != supportVectors_.getDimension())
     throw InvalidArgumentException(HERE) << "Invalid input dimension=" << dimension;
 
-  // compute the sum of the partial Hessians
-  const UnsignedInteger size = dataIn_.getSize();
-  SymmetricMatrix partialHessian(dimension);
-  for (UnsignedInteger i = 0; i < size; ++ i)
-    if (lagrangeMultiplier_[i] != 0.0)
-      partialHessian = partialHessian + lagrangeMultiplier_[i] * kernel_.partialHessian(inP, dataIn_[i]);
+  // sum the partial hessians, each kernel being computed once per support vector
+  Scalar value = 0.0;
+  Point gradient(dimension);
+  Point lowerHessian(dimension * dimension);
+  p_engine_->computeDerivatives(&inP[0], value, &gradient[0], &lowerHessian[0]);
 
   // return the result into a symmetric tensor
   SymmetricTensor result(dimension, 1);
   for(UnsignedInteger i = 0; i < dimension; ++ i)
     for(UnsignedInteger j = 0; j <= i; ++ j)
-      result(i, j, 0) = partialHessian(i, j);
+      result(i, j, 0) = lowerHessian[i * dimension + j];
 
   return result;
 }
@@ -106,7 +108,7 @@ SymmetricTensor SVMKernelRegressionHessian::hessian(const Point & inP) const
 /* Accessor for input point dimension */
 UnsignedInteger SVMKernelRegressionHessian::getInputDimension() const
 {
-  return dataIn_.getDimension();
+  return supportVectors_.getDimension();
 }
 
 /* Accessor for output point dimension */
@@ -121,7 +123,7 @@ void SVMKernelRegressionHessian::save(Advocate & adv) const
   HessianImplementation::save(adv);
   adv.saveAttribute("kernel_", kernel_);
   adv.saveAttribute("lagrangeMultiplier_", lagrangeMultiplier_);
-  adv.saveAttribute("dataIn_", dataIn_);
+  adv.saveAttribute("supportVectors_", supportVectors_);
   adv.saveAttribute("constant_", constant_);
 }
 
@@ -131,8 +133,17 @@ void SVMKernelRegressionHessian::load(Advocate & adv)
   HessianImplementation::load(adv);
   adv.loadAttribute("kernel_", kernel_);
   adv.loadAttribute("lagrangeMultiplier_", lagrangeMultiplier_);
-  adv.loadAttribute("dataIn_", dataIn_);
+  if (adv.hasAttribute("supportVectors_"))
+    adv.loadAttribute("supportVectors_", supportVectors_);
+  else
+  {
+    // studies saved before the packed storage hold the raw sample
+    Sample dataIn;
+    adv.loadAttribute("dataIn_", dataIn);
+    supportVectors_ = SupportVectorMatrix(dataIn);
+  }
   adv.loadAttribute("constant_", constant_);
+  p_engine_ = new SVMKernelEngine(kernel_, supportVectors_, lagrangeMultiplier_);
 }
 
 
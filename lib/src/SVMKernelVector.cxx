@@ -0,0 +1,370 @@
+//                                               -*- C++ -*-
+/**
+ *  @brief Vectorized block primitives of the kernel expansions
+ *
+ *  Copyright 2014-2024 Phimeca
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "otsvm/SVMKernelVector.hxx"
+
+#include <openturns/Exception.hxx>
+
+#include <cmath>
+#include <cstring>
+
+using namespace OT;
+
+/* GCC-style vector extensions and target attributes let each instruction
+   set be compiled in this file without global compiler flags */
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define OTSVM_KERNEL_VECTOR
+#endif
+
+namespace OTSVM
+{
+
+#ifdef OTSVM_KERNEL_VECTOR
+
+namespace
+{
+
+/* The helpers taking vectors by value are always inlined into the
+   functions compiled for the matching instruction set */
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+#define OTSVM_VECTOR_INLINE inline __attribute__((always_inline))
+
+typedef double Vector4 __attribute__((vector_size(32)));
+typedef double Vector8 __attribute__((vector_size(64)));
+
+template <class V>
+struct VectorTraits
+{
+  typedef decltype(V() < V()) Mask;
+  static const UnsignedInteger Size = sizeof(V) / sizeof(Scalar);
+};
+
+template <class V>
+OTSVM_VECTOR_INLINE V Load(const Scalar * p)
+{
+  V v;
+  std::memcpy(&v, p, sizeof(V));
+  return v;
+}
+
+template <class V>
+OTSVM_VECTOR_INLINE void Store(Scalar * p, const V & v)
+{
+  std::memcpy(p, &v, sizeof(V));
+}
+
+template <class V>
+OTSVM_VECTOR_INLINE V Broadcast(const Scalar s)
+{
+  V v;
+  for (UnsignedInteger i = 0; i < VectorTraits<V>::Size; ++ i)
+    v[i] = s;
+  return v;
+}
+
+template <class V>
+OTSVM_VECTOR_INLINE V Select(const typename VectorTraits<V>::Mask & mask, const V & a, const V & b)
+{
+  typedef typename VectorTraits<V>::Mask Mask;
+  return (V)(((Mask)a & mask) | ((Mask)b & ~mask));
+}
+
+template <class V>
+OTSVM_VECTOR_INLINE Scalar HorizontalSum(const V & v)
+{
+  Scalar sum = v[0];
+  for (UnsignedInteger i = 1; i < VectorTraits<V>::Size; ++ i)
+    sum += v[i];
+  return sum;
+}
+
+/* exp(x) = 2^k exp(r) with x = k ln2 + r, |r| <= ln2 / 2, ln2 split in two
+   parts so that k ln2hi is exact, and the Taylor polynomial of degree 13 */
+template <class V>
+OTSVM_VECTOR_INLINE V VectorExp(V x)
+{
+  typedef typename VectorTraits<V>::Mask Mask;
+  const V lower = Broadcast<V>(-708.0);
+  const V upper = Broadcast<V>(710.0);
+  const Mask underflow = x < lower;
+  const Mask overflow = x > upper;
+  x = Select<V>(underflow, lower, x);
+  x = Select<V>(overflow, upper, x);
+
+  // adding 1.5 * 2^52 rounds to the nearest integer, which lands in the low bits
+  const V shifter = Broadcast<V>(6755399441055744.0);
+  const V t = x * 1.4426950408889634074 + shifter;
+  const V k = t - shifter;
+  const Mask kBits = (Mask)t - (Mask)shifter;
+  V r = x - k * 6.93147180369123816490e-01;
+  r = r - k * 1.90821492927058770002e-10;
+
+  V p = Broadcast<V>(1.0 / 6227020800.0);
+  p = p * r + 1.0 / 479001600.0;
+  p = p * r + 1.0 / 39916800.0;
+  p = p * r + 1.0 / 3628800.0;
+  p = p * r + 1.0 / 362880.0;
+  p = p * r + 1.0 / 40320.0;
+  p = p * r + 1.0 / 5040.0;
+  p = p * r + 1.0 / 720.0;
+  p = p * r + 1.0 / 120.0;
+  p = p * r + 1.0 / 24.0;
+  p = p * r + 1.0 / 6.0;
+  p = p * r + 0.5;
+  p = p * r + 1.0;
+  p = p * r + 1.0;
+
+  // 2^k = 2 * 2^(k - 1) keeps the biased exponent in range up to k = 1024
+  const V scale = (V)((kBits + 1022) << 52);
+  const V value = (p * scale) * 2.0;
+  return Select<V>(underflow, Broadcast<V>(0.0), Select<V>(overflow, Broadcast<V>(INFINITY), value));
+}
+
+/* tanh(y) = sign(y) (1 - e) / (1 + e) with e = exp(-2|y|), and the odd
+   Taylor polynomial below 0.25 where 1 - e would cancel */
+template <class V>
+OTSVM_VECTOR_INLINE V VectorTanh(const V & y)
+{
+  typedef typename VectorTraits<V>::Mask Mask;
+  const Mask signBit = (Mask)Broadcast<V>(-0.0);
+  const Mask sign = (Mask)y & signBit;
+  const V a = (V)((Mask)y & ~signBit);
+
+  const V e = VectorExp<V>(- 2.0 * a);
+  const V large = (1.0 - e) / (1.0 + e);
+
+  const V a2 = a * a;
+  V p = Broadcast<V>(-3.927832388331683e-05);
+  p = p * a2 + 9.691537956929451e-05;
+  p = p * a2 - 2.3912911424355248e-04;
+  p = p * a2 + 5.90027440945586e-04;
+  p = p * a2 - 1.4558343870513183e-03;
+  p = p * a2 + 3.592128036572481e-03;
+  p = p * a2 - 8.863235529902197e-03;
+  p = p * a2 + 2.1869488536155203e-02;
+  p = p * a2 - 5.396825396825397e-02;
+  p = p * a2 + 1.3333333333333333e-01;
+  p = p * a2 - 3.333333333333333e-01;
+  const V small = a + a * a2 * p;
+
+  const V value = Select<V>(a < 0.25, small, large);
+  return (V)((Mask)value | sign);
+}
+
+template <class V>
+OTSVM_VECTOR_INLINE void VectorDots(const Scalar * x, const Scalar * data, const UnsignedInteger stride,
+                                    const UnsignedInteger * rows, const UnsignedInteger n, Scalar * out)
+{
+  const UnsignedInteger size = VectorTraits<V>::Size;
+  for (UnsignedInteger j = 0; j < n; ++ j)
+  {
+    const Scalar * row = data + rows[j] * stride;
+    V sum = {};
+    for (UnsignedInteger k = 0; k < stride; k += size)
+      sum += Load<V>(x + k) * Load<V>(row + k);
+    out[j] = HorizontalSum<V>(sum);
+  }
+}
+
+template <class V>
+OTSVM_VECTOR_INLINE void VectorSquaredDistances(const Scalar * x, const Scalar * data, const UnsignedInteger stride,
+    const UnsignedInteger * rows, const UnsignedInteger n, Scalar * out)
+{
+  const UnsignedInteger size = VectorTraits<V>::Size;
+  for (UnsignedInteger j = 0; j < n; ++ j)
+  {
+    const Scalar * row = data + rows[j] * stride;
+    V sum = {};
+    for (UnsignedInteger k = 0; k < stride; k += size)
+    {
+      const V delta = Load<V>(x + k) - Load<V>(row + k);
+      sum += delta * delta;
+    }
+    out[j] = HorizontalSum<V>(sum);
+  }
+}
+
+template <class V>
+OTSVM_VECTOR_INLINE void VectorExpBlock(Scalar * values, const UnsignedInteger n)
+{
+  const UnsignedInteger size = VectorTraits<V>::Size;
+  for (UnsignedInteger i = 0; i < n; i += size)
+    Store<V>(values + i, VectorExp<V>(Load<V>(values + i)));
+}
+
+template <class V>
+OTSVM_VECTOR_INLINE void VectorTanhBlock(Scalar * values, const UnsignedInteger n)
+{
+  const UnsignedInteger size = VectorTraits<V>::Size;
+  for (UnsignedInteger i = 0; i < n; i += size)
+    Store<V>(values + i, VectorTanh<V>(Load<V>(values + i)));
+}
+
+/* One instantiation per instruction set */
+__attribute__((target("avx2,fma")))
+void DotsAVX2(const Scalar * x, const Scalar * data, const UnsignedInteger stride,
+              const UnsignedInteger * rows, const UnsignedInteger n, Scalar * out)
+{
+  VectorDots<Vector4>(x, data, stride, rows, n, out);
+}
+
+__attribute__((target("avx2,fma")))
+void SquaredDistancesAVX2(const Scalar * x, const Scalar * data, const UnsignedInteger stride,
+                          const UnsignedInteger * rows, const UnsignedInteger n, Scalar * out)
+{
+  VectorSquaredDistances<Vector4>(x, data, stride, rows, n, out);
+}
+
+__attribute__((target("avx2,fma")))
+void ExpAVX2(Scalar * values, const UnsignedInteger n)
+{
+  VectorExpBlock<Vector4>(values, n);
+}
+
+__attribute__((target("avx2,fma")))
+void TanhAVX2(Scalar * values, const UnsignedInteger n)
+{
+  VectorTanhBlock<Vector4>(values, n);
+}
+
+__attribute__((target("avx512f")))
+void DotsAVX512(const Scalar * x, const Scalar * data, const UnsignedInteger stride,
+                const UnsignedInteger * rows, const UnsignedInteger n, Scalar * out)
+{
+  VectorDots<Vector8>(x, data, stride, rows, n, out);
+}
+
+__attribute__((target("avx512f")))
+void SquaredDistancesAVX512(const Scalar * x, const Scalar * data, const UnsignedInteger stride,
+                            const UnsignedInteger * rows, const UnsignedInteger n, Scalar * out)
+{
+  VectorSquaredDistances<Vector8>(x, data, stride, rows, n, out);
+}
+
+__attribute__((target("avx512f")))
+void ExpAVX512(Scalar * values, const UnsignedInteger n)
+{
+  VectorExpBlock<Vector8>(values, n);
+}
+
+__attribute__((target("avx512f")))
+void TanhAVX512(Scalar * values, const UnsignedInteger n)
+{
+  VectorTanhBlock<Vector8>(values, n);
+}
+
+struct Dispatch
+{
+  String name_;
+  void (*dots_)(const Scalar *, const Scalar *, const UnsignedInteger, const UnsignedInteger *, const UnsignedInteger, Scalar *);
+  void (*squaredDistances_)(const Scalar *, const Scalar *, const UnsignedInteger, const UnsignedInteger *, const UnsignedInteger, Scalar *);
+  void (*exp_)(Scalar *, const UnsignedInteger);
+  void (*tanh_)(Scalar *, const UnsignedInteger);
+};
+
+const Dispatch & GetDispatch()
+{
+  static const Dispatch dispatch = []()
+  {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+      return Dispatch({"avx512", DotsAVX512, SquaredDistancesAVX512, ExpAVX512, TanhAVX512});
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+      return Dispatch({"avx2", DotsAVX2, SquaredDistancesAVX2, ExpAVX2, TanhAVX2});
+    return Dispatch({"none", nullptr, nullptr, nullptr, nullptr});
+  }();
+  return dispatch;
+}
+
+}
+
+Bool SVMKernelVector::IsAvailable()
+{
+  return GetDispatch().dots_ != nullptr;
+}
+
+String SVMKernelVector::GetInstructionSet()
+{
+  return GetDispatch().name_;
+}
+
+void SVMKernelVector::Dots(const Scalar * x, const Scalar * data, const UnsignedInteger stride,
+                           const UnsignedInteger * rows, const UnsignedInteger n, Scalar * out)
+{
+  GetDispatch().dots_(x, data, stride, rows, n, out);
+}
+
+void SVMKernelVector::SquaredDistances(const Scalar * x, const Scalar * data, const UnsignedInteger stride,
+                                       const UnsignedInteger * rows, const UnsignedInteger n, Scalar * out)
+{
+  GetDispatch().squaredDistances_(x, data, stride, rows, n, out);
+}
+
+void SVMKernelVector::Exp(Scalar * values, const UnsignedInteger n)
+{
+  GetDispatch().exp_(values, n);
+}
+
+void SVMKernelVector::Tanh(Scalar * values, const UnsignedInteger n)
+{
+  GetDispatch().tanh_(values, n);
+}
+
+#else
+
+/* Without vector extensions the callers keep their scalar loops */
+Bool SVMKernelVector::IsAvailable()
+{
+  return false;
+}
+
+String SVMKernelVector::GetInstructionSet()
+{
+  return "none";
+}
+
+void SVMKernelVector::Dots(const Scalar *, const Scalar *, const UnsignedInteger,
+                           const UnsignedInteger *, const UnsignedInteger, Scalar *)
+{
+  throw NotYetImplementedException(HERE) << "No vectorized instruction set available";
+}
+
+void SVMKernelVector::SquaredDistances(const Scalar *, const Scalar *, const UnsignedInteger,
+                                       const UnsignedInteger *, const UnsignedInteger, Scalar *)
+{
+  throw NotYetImplementedException(HERE) << "No vectorized instruction set available";
+}
+
+void SVMKernelVector::Exp(Scalar *, const UnsignedInteger)
+{
+  throw NotYetImplementedException(HERE) << "No vectorized instruction set available";
+}
+
+void SVMKernelVector::Tanh(Scalar *, const UnsignedInteger)
+{
+  throw NotYetImplementedException(HERE) << "No vectorized instruction set available";
+}
+
+#endif
+
+
+}
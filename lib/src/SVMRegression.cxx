@@ -62,6 +62,32 @@ SVMRegression::SVMRegression(const Sample & dataIn,
   driver_.setP(1e-5);
 }
 
+/* Constructor with any kernel */
+SVMRegression::SVMRegression(const Sample & dataIn,
+                                   const Sample & dataOut,
+                                   const SVMKernel & kernel)
+  : PersistentObject()
+  , tradeoffFactor_(1, 10.)
+  , kernelParameter_(1, 0.0)
+  , inputSample_(dataIn)
+  , outputSample_(dataOut)
+{
+  driver_.setSvmType(LibSVM::EpsilonSupportRegression);
+  driver_.setKernel(kernel);
+  driver_.setP(1e-5);
+  // the kernel parameter defaults to the first parameter of the kernel
+  try
+  {
+    const Point parameter(kernel.getParameter());
+    if (parameter.getSize())
+      kernelParameter_[0] = parameter[0];
+  }
+  catch (const NotYetImplementedException &)
+  {
+    // no parameter
+  }
+}
+
 
 /* Virtual constructor */
 SVMRegression * SVMRegression::clone() const
@@ -79,8 +105,8 @@ void SVMRegression::run()
   if (outputSample_.getSize() != size)
     throw InvalidArgumentException(HERE) << "SVMRegression: the input sample and the output sample must have the same size";
 
-  Scalar bestTradeoffFactor = tradeoffFactor_[0];
-  Scalar bestKernelParameter = kernelParameter_[0];
+  Point bestTradeoffFactor(outputDimension, tradeoffFactor_[0]);
+  Point bestKernelParameter(outputDimension, kernelParameter_[0]);
 
   Function outputTransformation;
   Function outputInverseTransformation;
@@ -90,44 +116,46 @@ void SVMRegression::run()
   driver_.normalize(outputSample_, outputTransformation, outputInverseTransformation);
   Sample normalizedOutputSample(outputTransformation(outputSample_));
 
-  /* For each component of the output Sample , we compute the same algorithm.
-  * First, we make a cross validation to determinate the best parameters.
-  * Second, we train the problem and retrieve some results (support vectors, support vectors coefficients, kernel parameters).
+  /* The input sample is converted once for all the components of the output Sample.
+  * First, we make a cross validation of all the components to determinate their best parameters.
+  * Second, we train the components concurrently and retrieve some results (support vectors, support vectors coefficients, kernel parameters).
   * Third, we build the model with OT and save results in the MetaModelResult */
-  for (UnsignedInteger componentIndex = 0 ; componentIndex < outputDimension; ++ componentIndex)
-  {
-    driver_.convertData(inputSample_, normalizedOutputSample.getMarginal(componentIndex) );
+  driver_.convertData(inputSample_, normalizedOutputSample);
 
-    if (tradeoffFactor_.getSize() > 1 || kernelParameter_.getSize() > 1)
+  if (tradeoffFactor_.getSize() > 1 || kernelParameter_.getSize() > 1)
+  {
+    // the cells of the grid are cross-validated in parallel, kernel parameter
+    // first; ties still go to the first minimum with the tradeoff factor first
+    const Sample error(driver_.runCrossValidation(tradeoffFactor_, kernelParameter_));
+    for (UnsignedInteger componentIndex = 0 ; componentIndex < outputDimension; ++ componentIndex)
     {
       Scalar minerror = SpecFunc::MaxScalar;
       for (UnsignedInteger tradeoffIndex = 0 ; tradeoffIndex < tradeoffFactor_.getSize(); ++ tradeoffIndex)
       {
-        driver_.setTradeoffFactor( tradeoffFactor_[tradeoffIndex] );
-        for( UnsignedInteger kernelParameterIndex = 0 ; kernelParameterIndex < kernelParameter_.getSize() ; kernelParameterIndex ++)
+        for (UnsignedInteger kernelParameterIndex = 0 ; kernelParameterIndex < kernelParameter_.getSize() ; ++ kernelParameterIndex)
         {
-          driver_.setKernelParameter(kernelParameter_[kernelParameterIndex]);
-
-          const Scalar totalerror = driver_.runCrossValidation();
-
+          const Scalar totalerror = error(kernelParameterIndex * tradeoffFactor_.getSize() + tradeoffIndex, componentIndex);
           if (totalerror < minerror)
           {
             minerror = totalerror;
-            bestTradeoffFactor = tradeoffFactor_[tradeoffIndex];
-            bestKernelParameter = kernelParameter_[kernelParameterIndex];
+            bestTradeoffFactor[componentIndex] = tradeoffFactor_[tradeoffIndex];
+            bestKernelParameter[componentIndex] = kernelParameter_[kernelParameterIndex];
           }
-          LOGINFO( OSS() << "Cross Validation for C=" << tradeoffFactor_[tradeoffIndex] << " and gamma=" << kernelParameter_[kernelParameterIndex] << " error=" << totalerror );
+          LOGINFO( OSS() << "Cross Validation of output " << componentIndex << " for C=" << tradeoffFactor_[tradeoffIndex] << " and gamma=" << kernelParameter_[kernelParameterIndex] << " error=" << totalerror );
         }
       }
     }
-    driver_.setTradeoffFactor(bestTradeoffFactor);
-    driver_.setKernelParameter(bestKernelParameter);
-    driver_.performTrain();
+  }
+  driver_.performTrain(bestTradeoffFactor, bestKernelParameter);
+
+  for (UnsignedInteger componentIndex = 0 ; componentIndex < outputDimension; ++ componentIndex)
+  {
+    driver_.selectOutput(componentIndex);
 
     Point svcoef(driver_.getSupportVectorCoef());
 
-    Sample supportvector( driver_.getNumberSupportVector(), inputDimension );
-    supportvector = driver_.getSupportVector( inputDimension );
+    // the packed support vectors are shared by the evaluation, gradient and hessian
+    const SupportVectorMatrix supportvector(driver_.getSupportVector(inputDimension));
 
     const SVMKernel kernel(driver_.getKernel());
 
@@ -137,9 +165,9 @@ void SVMRegression::run()
     function.setHessian(new SVMKernelRegressionHessian(kernel, svcoef, supportvector, driver_.getConstant()));
 
     marginals.add( function );
-    driver_.destroy();
-    driver_.destroyModel();
   }
+  driver_.destroy();
+  driver_.destroyModel();
 
   AggregatedFunction aggregated(marginals);
   ComposedFunction composed(aggregated, driver_.getInputTransformation());
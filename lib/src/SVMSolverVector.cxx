@@ -0,0 +1,288 @@
+//                                               -*- C++ -*-
+/**
+ *  @brief Vectorized loops of the solver of the bundled libsvm
+ *
+ *  Copyright 2014-2024 Phimeca
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "otsvm/SVMSolverVector.hxx"
+#include "otsvm/SVMKernelVector.hxx"
+
+#include <cmath>
+#include <cstring>
+
+#include "svm.h"
+
+using namespace OT;
+
+/* Same conditions as the vectorized kernel expansions of SVMKernelVector */
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define OTSVM_SOLVER_VECTOR
+#endif
+
+namespace OTSVM
+{
+
+#ifdef OTSVM_SOLVER_VECTOR
+
+namespace
+{
+
+/* The helpers taking vectors by value are always inlined into the
+   functions compiled for the matching instruction set */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+#define OTSVM_SOLVER_INLINE inline __attribute__((always_inline))
+
+typedef double Double4 __attribute__((vector_size(32)));
+typedef float Float4 __attribute__((vector_size(16)));
+typedef int Int4 __attribute__((vector_size(16)));
+typedef double Double8 __attribute__((vector_size(64)));
+typedef float Float8 __attribute__((vector_size(32)));
+
+/* Threshold of the quadratic coefficients, TAU of svm.cpp */
+const double Tau = 1e-12;
+
+/* Types of N lanes */
+template <int N> struct SolverVector;
+
+template <>
+struct SolverVector<4>
+{
+  typedef Double4 Double;
+  typedef Float4 Float;
+  typedef decltype(Double() < Double()) Mask;
+};
+
+template <>
+struct SolverVector<8>
+{
+  typedef Double8 Double;
+  typedef Float8 Float;
+  typedef decltype(Double() < Double()) Mask;
+};
+
+template <class V>
+OTSVM_SOLVER_INLINE V Load(const void * p)
+{
+  V v;
+  std::memcpy(&v, p, sizeof(V));
+  return v;
+}
+
+/* N signed bytes as doubles: the compilers split a direct conversion of a
+   byte vector into scalar instructions, the bytes are rather spread over
+   32 bits lanes by shifts */
+template <int N>
+OTSVM_SOLVER_INLINE typename SolverVector<N>::Double Widen(const signed char * p);
+
+template <>
+OTSVM_SOLVER_INLINE Double4 Widen<4>(const signed char * p)
+{
+  int u;
+  std::memcpy(&u, p, sizeof(u));
+  const Int4 shift = {24, 16, 8, 0};
+  const Int4 v = {u, u, u, u};
+  return __builtin_convertvector((v << shift) >> 24, Double4);
+}
+
+/* AVX-512F holds FMA instructions: a product passed through this barrier
+   is rounded before it is added, as in the scalar loops */
+template <class V>
+OTSVM_SOLVER_INLINE V Round(const V & x)
+{
+  V v = x;
+  __asm__("" : "+v"(v));
+  return v;
+}
+
+template <class V, class M>
+OTSVM_SOLVER_INLINE V Select(const M & mask, const V & a, const V & b)
+{
+  return (V)(((M)a & mask) | ((M)b & ~mask));
+}
+
+/* i maximizing -y_i G_i out of the excluded bounds, from begin */
+template <int N>
+OTSVM_SOLVER_INLINE int MaxViolation(const signed char * y, const double * G, const char * alphaStatus,
+                                     const char boundP, const char boundN, const int begin, const int end,
+                                     double * Gmax, int * GmaxIndex)
+{
+  typedef typename SolverVector<N>::Double Double;
+  typedef typename SolverVector<N>::Mask Mask;
+  Double best, bestIndex, index;
+  for (int k = 0; k < N; ++ k)
+  {
+    best[k] = -HUGE_VAL;
+    bestIndex[k] = -1;
+    index[k] = begin + k;
+  }
+  const Double minusInfinity = best;
+  int t = begin;
+  for (; t + N <= end; t += N)
+  {
+    const Double yt = Widen<N>(y + t);
+    const Double status = Widen<N>((const signed char *)alphaStatus + t);
+    const Mask in = ((yt > 0) & (status != boundP)) | ((yt <= 0) & (status != boundN));
+    const Double v = Select(in, -yt * Load<Double>(G + t), minusInfinity);
+    const Mask take = v >= best;
+    best = Select(take, v, best);
+    bestIndex = Select(take, index, bestIndex);
+    index += N;
+  }
+  for (int k = 0; k < N; ++ k)
+    if (best[k] > *Gmax || (best[k] == *Gmax && bestIndex[k] > *GmaxIndex))
+    {
+      *Gmax = best[k];
+      *GmaxIndex = (int)bestIndex[k];
+    }
+  return t;
+}
+
+/* Largest y_j G_j and j minimizing the decrease of the objective out of
+   the excluded bounds, from begin */
+template <int N>
+OTSVM_SOLVER_INLINE int MinObjDiff(const signed char * y, const double * G, const char * alphaStatus,
+                                   const char boundP, const char boundN, const double * QD, const float * Qi,
+                                   const double QDi, const double yi, const double Gmax, const int begin, const int end,
+                                   double * Gmax2, double * objDiffMin, int * GminIndex)
+{
+  typedef typename SolverVector<N>::Double Double;
+  typedef typename SolverVector<N>::Float Float;
+  typedef typename SolverVector<N>::Mask Mask;
+  Double max2, best, bestIndex, index, tau;
+  for (int k = 0; k < N; ++ k)
+  {
+    max2[k] = -HUGE_VAL;
+    best[k] = HUGE_VAL;
+    bestIndex[k] = -1;
+    index[k] = begin + k;
+    tau[k] = Tau;
+  }
+  const Double minusInfinity = max2;
+  const Double infinity = best;
+  int j = begin;
+  for (; j + N <= end; j += N)
+  {
+    const Double yt = Widen<N>(y + j);
+    const Double status = Widen<N>((const signed char *)alphaStatus + j);
+    const Mask inLow = ((yt > 0) & (status != boundP)) | ((yt <= 0) & (status != boundN));
+    const Double yG = Round(yt * Load<Double>(G + j));
+    const Double v = Select(inLow, yG, minusInfinity);
+    max2 = Select(v >= max2, v, max2);
+    const Double gradDiff = Gmax + yG;
+    const Double Qij = __builtin_convertvector(Load<Float>(Qi + j), Double);
+    Double quadCoef = QDi + Load<Double>(QD + j) - Round(yi * yt * Qij);
+    quadCoef = Select(quadCoef <= 0, tau, quadCoef);
+    const Double objDiff = Select(inLow & (gradDiff > 0), -(gradDiff * gradDiff) / quadCoef + 0.0, infinity);
+    const Mask take = objDiff <= best;
+    best = Select(take, objDiff, best);
+    bestIndex = Select(take, index, bestIndex);
+    index += N;
+  }
+  for (int k = 0; k < N; ++ k)
+  {
+    if (max2[k] >= *Gmax2)
+      *Gmax2 = max2[k];
+    if (best[k] < *objDiffMin || (best[k] == *objDiffMin && bestIndex[k] > *GminIndex))
+    {
+      *objDiffMin = best[k];
+      *GminIndex = (int)bestIndex[k];
+    }
+  }
+  return j;
+}
+
+template <int N>
+OTSVM_SOLVER_INLINE int UpdateGradient(double * G, const float * Qi, const float * Qj,
+                                       const double deltaAlphaI, const double deltaAlphaJ,
+                                       const int begin, const int end)
+{
+  typedef typename SolverVector<N>::Double Double;
+  typedef typename SolverVector<N>::Float Float;
+  int k = begin;
+  for (; k + N <= end; k += N)
+  {
+    const Double Qik = __builtin_convertvector(Load<Float>(Qi + k), Double);
+    const Double Qjk = __builtin_convertvector(Load<Float>(Qj + k), Double);
+    const Double Gk = Load<Double>(G + k) + (Round(Qik * deltaAlphaI) + Round(Qjk * deltaAlphaJ));
+    std::memcpy(G + k, &Gk, sizeof(Double));
+  }
+  return k;
+}
+
+/* One instantiation per instruction set */
+__attribute__((target("avx2")))
+int MaxViolationAVX2(const signed char * y, const double * G, const char * alphaStatus,
+                     char boundP, char boundN, int begin, int end, double * Gmax, int * GmaxIndex)
+{
+  return MaxViolation<4>(y, G, alphaStatus, boundP, boundN, begin, end, Gmax, GmaxIndex);
+}
+
+__attribute__((target("avx2")))
+int MinObjDiffAVX2(const signed char * y, const double * G, const char * alphaStatus,
+                   char boundP, char boundN, const double * QD, const float * Qi, double QDi, double yi, double Gmax,
+                   int begin, int end, double * Gmax2, double * objDiffMin, int * GminIndex)
+{
+  return MinObjDiff<4>(y, G, alphaStatus, boundP, boundN, QD, Qi, QDi, yi, Gmax, begin, end, Gmax2, objDiffMin, GminIndex);
+}
+
+__attribute__((target("avx2")))
+int UpdateGradientAVX2(double * G, const float * Qi, const float * Qj,
+                       double deltaAlphaI, double deltaAlphaJ, int begin, int end)
+{
+  return UpdateGradient<4>(G, Qi, Qj, deltaAlphaI, deltaAlphaJ, begin, end);
+}
+
+__attribute__((target("avx512f")))
+int UpdateGradientAVX512(double * G, const float * Qi, const float * Qj,
+                         double deltaAlphaI, double deltaAlphaJ, int begin, int end)
+{
+  return UpdateGradient<8>(G, Qi, Qj, deltaAlphaI, deltaAlphaJ, begin, end);
+}
+
+#pragma GCC diagnostic pop
+
+/* The compilers split the comparisons of 8 doubles into scalar ones: the
+   scans keep 4 lanes with AVX-512 */
+const svm_solver_loops AVX2Loops = {MaxViolationAVX2, MinObjDiffAVX2, UpdateGradientAVX2};
+const svm_solver_loops AVX512Loops = {MaxViolationAVX2, MinObjDiffAVX2, UpdateGradientAVX512};
+
+}
+
+const svm_solver_loops * SVMSolverVector::GetLoops()
+{
+  const String instructionSet(SVMKernelVector::GetInstructionSet());
+  if (instructionSet == "avx512")
+    return &AVX512Loops;
+  if (instructionSet == "avx2")
+    return &AVX2Loops;
+  return nullptr;
+}
+
+#else
+
+/* Without vector extensions the solver keeps its scalar loops */
+const svm_solver_loops * SVMSolverVector::GetLoops()
+{
+  return nullptr;
+}
+
+#endif
+
+}
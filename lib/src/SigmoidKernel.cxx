@@ -135,7 +135,7 @@ SymmetricMatrix SigmoidKernel::partialHessian( const Point & x1, const Point & x
   {
     for (UnsignedInteger j = 0 ; j <= i ; ++ j)
     {
-      result(i, j) = 2 * linear_ * x2[i] * linear_ * x2[j] * ( 1 - std::pow( tanh(linear_ * dotProduct + constant_), 2 )) * tanh( linear_ * dotProduct + constant_ );
+      result(i, j) = - 2 * linear_ * x2[i] * linear_ * x2[j] * ( 1 - std::pow( tanh(linear_ * dotProduct + constant_), 2 )) * tanh( linear_ * dotProduct + constant_ );
     }
   }
 
@@ -0,0 +1,151 @@
+//                                               -*- C++ -*-
+/**
+ *  @brief Packed storage of the support vectors of a kernel expansion
+ *
+ *  Copyright 2014-2024 Phimeca
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "otsvm/SupportVectorMatrix.hxx"
+#include <openturns/PersistentObjectFactory.hxx>
+
+#include <cstdint>
+
+using namespace OT;
+
+namespace OTSVM
+{
+
+CLASSNAMEINIT(SupportVectorMatrix)
+
+static Factory<SupportVectorMatrix> RegisteredFactory_SupportVectorMatrix;
+
+/* Default constructor */
+SupportVectorMatrix::SupportVectorMatrix()
+  : PersistentObject()
+{
+  // Nothing to do
+}
+
+/* Constructor from the support vectors */
+SupportVectorMatrix::SupportVectorMatrix(const Sample & supportVectors)
+  : PersistentObject()
+{
+  pack(supportVectors);
+}
+
+/* Virtual constructor */
+SupportVectorMatrix * SupportVectorMatrix::clone() const
+{
+  return new SupportVectorMatrix(*this);
+}
+
+/* Copy the rows into a zero-padded, aligned buffer */
+void SupportVectorMatrix::pack(const Sample & supportVectors)
+{
+  size_ = supportVectors.getSize();
+  dimension_ = supportVectors.getDimension();
+  const UnsignedInteger rowAlignment = Alignment / sizeof(Scalar);
+  stride_ = ((dimension_ + rowAlignment - 1) / rowAlignment) * rowAlignment;
+
+  p_buffer_ = new std::vector<Scalar>(size_ * stride_ + rowAlignment, 0.0);
+  const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(p_buffer_->data());
+  const std::uintptr_t offset = (Alignment - address % Alignment) % Alignment;
+  Scalar * rows = p_buffer_->data() + offset / sizeof(Scalar);
+  for (UnsignedInteger i = 0; i < size_; ++ i)
+    for (UnsignedInteger j = 0; j < dimension_; ++ j)
+      rows[i * stride_ + j] = supportVectors(i, j);
+  data_ = rows;
+}
+
+/* Comparison operator */
+Bool SupportVectorMatrix::operator==(const SupportVectorMatrix & other) const
+{
+  if (this == &other) return true;
+  if ((size_ != other.size_) || (dimension_ != other.dimension_)) return false;
+  for (UnsignedInteger i = 0; i < size_; ++ i)
+    for (UnsignedInteger j = 0; j < dimension_; ++ j)
+      if (data(i)[j] != other.data(i)[j]) return false;
+  return true;
+}
+
+/* String converter */
+String SupportVectorMatrix::__repr__() const
+{
+  OSS oss;
+  oss << "class=" << SupportVectorMatrix::GetClassName()
+      << " support vectors=" << getSample();
+  return oss;
+}
+
+/* Number of support vectors */
+UnsignedInteger SupportVectorMatrix::getSize() const
+{
+  return size_;
+}
+
+/* Dimension of the support vectors */
+UnsignedInteger SupportVectorMatrix::getDimension() const
+{
+  return dimension_;
+}
+
+/* Distance between two consecutive rows */
+UnsignedInteger SupportVectorMatrix::getStride() const
+{
+  return stride_;
+}
+
+/* Aligned pointer to the first row */
+const Scalar * SupportVectorMatrix::data() const
+{
+  return data_;
+}
+
+/* Aligned pointer to the given row */
+const Scalar * SupportVectorMatrix::data(const UnsignedInteger index) const
+{
+  return data_ + index * stride_;
+}
+
+/* Support vectors as a Sample */
+Sample SupportVectorMatrix::getSample() const
+{
+  Sample sample(size_, dimension_);
+  for (UnsignedInteger i = 0; i < size_; ++ i)
+    for (UnsignedInteger j = 0; j < dimension_; ++ j)
+      sample(i, j) = data(i)[j];
+  return sample;
+}
+
+/* Method save() stores the object through the StorageManager */
+void SupportVectorMatrix::save(Advocate & adv) const
+{
+  PersistentObject::save(adv);
+  adv.saveAttribute("supportVectors_", getSample());
+}
+
+/* Method load() reloads the object from the StorageManager */
+void SupportVectorMatrix::load(Advocate & adv)
+{
+  PersistentObject::load(adv);
+  Sample supportVectors;
+  adv.loadAttribute("supportVectors_", supportVectors);
+  pack(supportVectors);
+}
+
+
+}
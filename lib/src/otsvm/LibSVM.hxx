@@ -25,6 +25,7 @@
 
 #include "otsvm/SVMKernel.hxx"
 #include <openturns/Function.hxx>
+#include <openturns/Indices.hxx>
 
 struct svm_model;
 struct svm_node;
@@ -40,7 +41,7 @@ class OTSVM_API LibSVM : public OT::PersistentObject
 
 public:
 
-  enum KernelType { Linear, Polynomial, NormalRbf, Sigmoid };
+  enum KernelType { Linear, Polynomial, NormalRbf, Sigmoid, Precomputed };
   enum SvmType { CSupportClassification, EpsilonSupportRegression};
 
   /* Constructor */
@@ -49,7 +50,8 @@ public:
   /* Virtual Constructor */
   LibSVM * clone() const override;
 
-  /* Kernel parameter accessor */
+  /* Kernel parameter accessor: sigma of the Gaussian kernel of libsvm, or
+     the first parameter of a kernel set by setKernel, whatever it means */
   void setKernelParameter(const OT::Scalar kernelParameter);
 
   /* Tradeoff factor accessor */
@@ -79,7 +81,13 @@ public:
   void setKernelType(const OT::UnsignedInteger kernelType);
 
   SVMKernel getKernel() const;
+
+  /* Kernel accessor, any kernel being trained through its Gram matrix */
+  void setKernel(const SVMKernel & kernel);
   
+  /* Number of threads of the solver, 0 for the OpenTURNS thread number */
+  void setNumberOfThreads(const OT::UnsignedInteger threadNumber);
+
   /* SvmType accessor */
   void setSvmType(const OT::UnsignedInteger svmType);
 
@@ -108,6 +116,12 @@ public:
   /* Perform Train method */
   void performTrain();
 
+  /* Train all the outputs at once, each with its tradeoff factor and kernel parameter */
+  void performTrain(const OT::Point & tradeoffFactor, const OT::Point & kernelParameter);
+
+  /* Select the model of an output trained at once */
+  void selectOutput(const OT::UnsignedInteger index);
+
   /* Perform Error method */
   OT::Scalar computeError();
 
@@ -123,6 +137,9 @@ public:
 
   OT::Scalar runCrossValidation();
 
+  /* Cross validation errors of a grid of parameters, the kernel parameter in the outer loop, for each output */
+  OT::Sample runCrossValidation(const OT::Point & tradeoffFactor, const OT::Point & kernelParameter);
+
   /* Destroy the libsvm problem */
   void destroy();
 
@@ -135,6 +152,12 @@ public:
   /* Grade a point as if it were associated to a class */
   OT::UnsignedInteger getLabelValues(const OT::Point & vector, const OT::SignedInteger outC) const;
 
+  /* Associate the points of a sample with classes */
+  OT::Indices getLabel(const OT::Sample & sample) const;
+
+  /* Grade the points of a sample as if they were associated to classes */
+  OT::Point getLabelValues(const OT::Sample & sample, const OT::Indices & outC) const;
+
   OT::Scalar predict(const OT::Point & inP) const;
 
   void setWeight(const OT::Point & weight, const OT::Point & label);
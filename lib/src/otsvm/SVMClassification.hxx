@@ -60,16 +60,23 @@ public:
   */
   OT::UnsignedInteger classify(const OT::Point & vector) const override;
 
+  /* Associate the points of a sample with classes, in parallel */
+  OT::Indices classify(const OT::Sample & inS) const override;
+
   /* String converter */
   OT::String __repr__() const override;
 
   /* Grade a point as if it were associated to a class */
   OT::Scalar grade(const OT::Point & inP, const OT::UnsignedInteger outC) const override;
+
+  /* Grade the points of a sample as if they were associated to classes, in parallel */
+  OT::Point grade(const OT::Sample & inS, const OT::Indices & outC) const override;
   OT::Scalar predict(const OT::Point & inP) const;
 
   void runKMeans(const OT::UnsignedInteger k);
 
   void setKernelType(const LibSVM::KernelType & kerneltype);
+  void setKernel(const SVMKernel & kernel);
   void setTradeoffFactor(const OT::Point & tradeofFactor);
   void setKernelParameter(const OT::Point & kernelParameter);
   void setWeight(const OT::Point & weight);
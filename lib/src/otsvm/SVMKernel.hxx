@@ -74,6 +74,12 @@ public:
   /** Partial hessian */
   OT::SymmetricMatrix partialHessian(const OT::Point & x1, const OT::Point & x2) const;
 
+  /** Gram matrix K_ij = k(x_i, x_j) */
+  OT::SymmetricMatrix computeGram(const OT::Sample & x) const;
+
+  /** Cross-kernel matrix K_ij = k(x1_i, x2_j) */
+  OT::Matrix computeCrossKernel(const OT::Sample & x1, const OT::Sample & x2) const;
+
 } ; /* class SVMKernel */
 
 }
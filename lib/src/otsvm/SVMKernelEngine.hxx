@@ -0,0 +1,173 @@
+//                                               -*- C++ -*-
+/**
+ *  @brief Kernel expansion specialized on the kernel family
+ *
+ *  Copyright 2014-2024 Phimeca
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OTSVM_SVMKERNELENGINE_HXX
+#define OTSVM_SVMKERNELENGINE_HXX
+
+#include <openturns/Indices.hxx>
+#include "otsvm/SVMKernel.hxx"
+#include "otsvm/SupportVectorMatrix.hxx"
+
+namespace OTSVM
+{
+
+/**
+ * @class SVMKernelEngine
+ *
+ * Evaluates sum_j c_j k(sv_j, x) over packed support vectors.
+ * The built-in kernels are recognized once at construction and evaluated
+ * by templated loops working on raw rows; any other kernel goes through
+ * the virtual SVMKernel interface.
+ * The radial kernels use the explicit differences x - sv like operator().
+ * When SVMKernel-UseVectorization is set and the CPU allows it, blocks of
+ * support vectors go through the SIMD primitives of SVMKernelVector, whose
+ * kernel values agree with the scalar ones within the bound given there.
+ * This header is not installed.
+ */
+class OTSVM_LOCAL SVMKernelEngine
+{
+public:
+
+  enum Family { Generic, NormalRbf, ExponentialRbf, Rational, Polynomial, Sigmoid, Linear };
+
+  /** Default constructor */
+  SVMKernelEngine();
+
+  /** Constructor with parameters */
+  SVMKernelEngine(const SVMKernel & kernel,
+                  const SupportVectorMatrix & supportVectors,
+                  const OT::Point & coefficients);
+
+  /** Constructor recognizing the family of a kernel, for the matrices only */
+  explicit SVMKernelEngine(const SVMKernelImplementation & kernel);
+
+  /** Kernel family accessor */
+  Family getFamily() const;
+
+  /** Number of support vectors with a non-zero coefficient */
+  OT::UnsignedInteger getSize() const;
+
+  /** Add the terms [begin, end) of the expansion at x to output, in order */
+  OT::Scalar accumulate(const OT::Scalar * x,
+                        const OT::UnsignedInteger begin,
+                        const OT::UnsignedInteger end,
+                        const OT::Scalar output) const;
+
+  /** Kernel values k(sv_j, x) of the active support vectors [begin, end),
+      written in values[0, end - begin) */
+  void computeKernelValues(const OT::Scalar * x,
+                           const OT::UnsignedInteger begin,
+                           const OT::UnsignedInteger end,
+                           OT::Scalar * values) const;
+
+  /** Add the gradients of the terms [begin, end) of the expansion at x to
+      gradient, in order, on the explicit differences x - sv */
+  void accumulateGradient(const OT::Scalar * x,
+                          const OT::UnsignedInteger begin,
+                          const OT::UnsignedInteger end,
+                          OT::Scalar * gradient) const;
+
+  /** Add the value, gradient and, when hessian is not null, the lower
+      triangle of the row-major hessian of the expansion at x to the
+      arguments, computing each kernel once per support vector */
+  void computeDerivatives(const OT::Scalar * x,
+                          OT::Scalar & value,
+                          OT::Scalar * gradient,
+                          OT::Scalar * hessian) const;
+
+  /** Gram matrix of a built-in family, false for a generic kernel */
+  OT::Bool computeGram(const OT::Sample & x, OT::SymmetricMatrix & gram) const;
+
+  /** Cross-kernel matrix of a built-in family, false for a generic kernel */
+  OT::Bool computeCrossKernel(const OT::Sample & x1, const OT::Sample & x2, OT::Matrix & crossKernel) const;
+
+private:
+
+  void setFamily(const SVMKernelImplementation & implementation);
+
+  template <class Profile>
+  OT::Scalar accumulateProfile(const Profile & profile, const OT::Scalar * x,
+                               const OT::UnsignedInteger begin, const OT::UnsignedInteger end,
+                               const OT::Scalar output) const;
+
+  template <class Profile>
+  OT::Scalar accumulateScalar(const Profile & profile, const OT::Scalar * x,
+                              const OT::UnsignedInteger begin, const OT::UnsignedInteger end,
+                              OT::Scalar output) const;
+
+  template <class Profile>
+  OT::Scalar accumulateVector(const Profile & profile, const OT::Scalar * x,
+                              const OT::UnsignedInteger begin, const OT::UnsignedInteger end,
+                              OT::Scalar output) const;
+
+  template <class Profile>
+  void computeProfileValues(const Profile & profile, const OT::Scalar * x,
+                            const OT::UnsignedInteger begin, const OT::UnsignedInteger end,
+                            OT::Scalar * values) const;
+
+  void computeGenericValues(const OT::Scalar * x,
+                            const OT::UnsignedInteger begin, const OT::UnsignedInteger end,
+                            OT::Scalar * values) const;
+
+  template <class Profile>
+  void accumulateProfileGradient(const Profile & profile, const OT::Scalar * x,
+                                 const OT::UnsignedInteger begin, const OT::UnsignedInteger end,
+                                 OT::Scalar * gradient) const;
+
+  void accumulateGenericGradient(const OT::Scalar * x,
+                                 const OT::UnsignedInteger begin, const OT::UnsignedInteger end,
+                                 OT::Scalar * gradient) const;
+
+  template <class Profile>
+  void computeProfileDerivatives(const Profile & profile, const OT::Scalar * x,
+                                 OT::Scalar & value, OT::Scalar * gradient, OT::Scalar * hessian) const;
+
+  void computeGenericDerivatives(const OT::Scalar * x,
+                                 OT::Scalar & value, OT::Scalar * gradient, OT::Scalar * hessian) const;
+
+  OT::Scalar accumulateGeneric(const OT::Scalar * x,
+                               const OT::UnsignedInteger begin, const OT::UnsignedInteger end,
+                               OT::Scalar output) const;
+
+  Family family_ = Generic;
+
+  /* Whether the SIMD primitives are used, see SVMKernelVector */
+  OT::Bool vectorized_ = false;
+
+  /* Kernel parameters of the specialized families */
+  OT::Scalar scale_ = 0.0;
+  OT::Scalar linear_ = 0.0;
+  OT::Scalar constant_ = 0.0;
+  OT::Scalar degree_ = 0.0;
+
+  SVMKernel kernel_;
+  SupportVectorMatrix supportVectors_;
+
+  /* Rows and coefficients of the active support vectors */
+  OT::Indices active_;
+  OT::Point coefficients_;
+
+}; /* class SVMKernelEngine */
+
+
+}
+
+#endif /* OTSVM_SVMKERNELENGINE_HXX */
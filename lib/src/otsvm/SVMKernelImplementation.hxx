@@ -23,6 +23,7 @@
 
 #include <openturns/PointWithDescription.hxx>
 #include <openturns/SymmetricMatrix.hxx>
+#include <openturns/Sample.hxx>
 #include "otsvm/OTSVMprivate.hxx"
 
 namespace OTSVM
@@ -66,6 +67,15 @@ public:
   /** Partial hessian */
   virtual OT::SymmetricMatrix partialHessian(const OT::Point & x1, const OT::Point & x2) const;
 
+  /** Gram matrix K_ij = k(x_i, x_j).
+      The built-in kernels use specialized loops; any other kernel, including
+      a class derived from a built-in one, is evaluated pair by pair through
+      operator() from several threads, so operator() must be thread-safe */
+  virtual OT::SymmetricMatrix computeGram(const OT::Sample & x) const;
+
+  /** Cross-kernel matrix K_ij = k(x1_i, x2_j), same rules as computeGram */
+  virtual OT::Matrix computeCrossKernel(const OT::Sample & x1, const OT::Sample & x2) const;
+
   /** Method save() stores the object through the StorageManager */
   void save(OT::Advocate & adv) const override;
 
@@ -0,0 +1,407 @@
+//                                               -*- C++ -*-
+/**
+ *  @brief Kernel profiles shared by the specialized kernel computations
+ *
+ *  Copyright 2014-2024 Phimeca
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OTSVM_SVMKERNELPROFILE_HXX
+#define OTSVM_SVMKERNELPROFILE_HXX
+
+#include <openturns/Matrix.hxx>
+#include <openturns/SymmetricMatrix.hxx>
+#include <openturns/Indices.hxx>
+#include <openturns/ResourceMap.hxx>
+#include <openturns/TBBImplementation.hxx>
+#include "otsvm/SupportVectorMatrix.hxx"
+#include "otsvm/SVMKernelVector.hxx"
+
+#include <cmath>
+
+/* This header is not installed: the built-in kernels are all functions
+   of a single scalar argument, and the templates below evaluate them over
+   many pairs of points at once */
+
+namespace OTSVM
+{
+
+/* Argument of the kernel profiles: the dot product x.sv, the squared
+   distance from the cached norms as |x|^2 + |sv|^2 - 2 x.sv, or the
+   squared distance from the explicit difference, needed by the square root
+   of the exponential kernel that would amplify the cancellation near 0.
+   The expanded form only serves the matrix products of the Gram matrices:
+   its absolute error eps (|x|^2 + |sv|^2) is not relative to the distance,
+   so SVMKernelEngine takes the explicit difference for all radial kernels */
+enum Argument { DotProduct, ExpandedDistance, Distance };
+
+/* Each profile maps its argument s to the kernel value, one at a time or
+   in place over a block of values with the vectorized primitives, and
+   gives the derivatives f1 = df/ds and f2 = d2f/ds2 used by the gradient
+   and hessian:
+   - radial kernels, with s = |x - sv|^2 and d = x - sv:
+     grad = 2 f1 d, hess = 2 f1 I + 4 f2 d d^T
+   - dot-product kernels, with s = x.sv:
+     grad = f1 sv, hess = f2 sv sv^T */
+struct NormalRBFProfile
+{
+  static const Argument Type = ExpandedDistance;
+  OT::Scalar scale;
+  OT::Scalar operator()(const OT::Scalar r2) const
+  {
+    return exp(- r2 / scale);
+  }
+  void derivatives(const OT::Scalar r2, OT::Scalar & f, OT::Scalar & f1, OT::Scalar & f2) const
+  {
+    f = exp(- r2 / scale);
+    f1 = - f / scale;
+    f2 = f / (scale * scale);
+  }
+  void transform(OT::Scalar * values, const OT::UnsignedInteger n) const
+  {
+    for (OT::UnsignedInteger i = 0; i < n; ++ i)
+      values[i] = - values[i] / scale;
+    SVMKernelVector::Exp(values, n);
+  }
+};
+
+struct ExponentialRBFProfile
+{
+  static const Argument Type = Distance;
+  OT::Scalar scale;
+  OT::Scalar operator()(const OT::Scalar r2) const
+  {
+    return exp(- sqrt(r2) / scale);
+  }
+  void derivatives(const OT::Scalar r2, OT::Scalar & f, OT::Scalar & f1, OT::Scalar & f2) const
+  {
+    // chain rule through r = sqrt(r2); the kernel is not differentiable at 0
+    const OT::Scalar r = sqrt(r2);
+    f = exp(- r / scale);
+    f1 = 0.0;
+    f2 = 0.0;
+    if (r > 0.0)
+    {
+      const OT::Scalar fr = - f / scale;
+      const OT::Scalar frr = f / (scale * scale);
+      f1 = fr / (2.0 * r);
+      f2 = (frr - fr / r) / (4.0 * r2);
+    }
+  }
+  void transform(OT::Scalar * values, const OT::UnsignedInteger n) const
+  {
+    for (OT::UnsignedInteger i = 0; i < n; ++ i)
+      values[i] = - sqrt(values[i]) / scale;
+    SVMKernelVector::Exp(values, n);
+  }
+};
+
+struct RationalProfile
+{
+  static const Argument Type = ExpandedDistance;
+  OT::Scalar constant;
+  OT::Scalar operator()(const OT::Scalar r2) const
+  {
+    return 1.0 - r2 / (r2 + constant);
+  }
+  void derivatives(const OT::Scalar r2, OT::Scalar & f, OT::Scalar & f1, OT::Scalar & f2) const
+  {
+    const OT::Scalar denominator = r2 + constant;
+    f = 1.0 - r2 / denominator;
+    f1 = - constant / (denominator * denominator);
+    f2 = 2.0 * constant / (denominator * denominator * denominator);
+  }
+  void transform(OT::Scalar * values, const OT::UnsignedInteger n) const
+  {
+    for (OT::UnsignedInteger i = 0; i < n; ++ i)
+      values[i] = operator()(values[i]);
+  }
+};
+
+struct PolynomialProfile
+{
+  static const Argument Type = DotProduct;
+  OT::Scalar linear;
+  OT::Scalar constant;
+  OT::Scalar degree;
+  OT::Scalar operator()(const OT::Scalar t) const
+  {
+    return std::pow(linear * t + constant, degree);
+  }
+  void derivatives(const OT::Scalar t, OT::Scalar & f, OT::Scalar & f1, OT::Scalar & f2) const
+  {
+    const OT::Scalar u = linear * t + constant;
+    f = std::pow(u, degree);
+    f1 = (degree >= 1.0) ? degree * std::pow(u, degree - 1.0) * linear : 0.0;
+    f2 = (degree >= 2.0) ? degree * (degree - 1.0) * std::pow(u, degree - 2.0) * linear * linear : 0.0;
+  }
+  void transform(OT::Scalar * values, const OT::UnsignedInteger n) const
+  {
+    for (OT::UnsignedInteger i = 0; i < n; ++ i)
+      values[i] = operator()(values[i]);
+  }
+};
+
+struct SigmoidProfile
+{
+  static const Argument Type = DotProduct;
+  OT::Scalar linear;
+  OT::Scalar constant;
+  OT::Scalar operator()(const OT::Scalar t) const
+  {
+    return tanh(linear * t + constant);
+  }
+  void derivatives(const OT::Scalar t, OT::Scalar & f, OT::Scalar & f1, OT::Scalar & f2) const
+  {
+    f = tanh(linear * t + constant);
+    f1 = linear * (1.0 - f * f);
+    f2 = - 2.0 * linear * linear * f * (1.0 - f * f);
+  }
+  void transform(OT::Scalar * values, const OT::UnsignedInteger n) const
+  {
+    for (OT::UnsignedInteger i = 0; i < n; ++ i)
+      values[i] = linear * values[i] + constant;
+    SVMKernelVector::Tanh(values, n);
+  }
+};
+
+struct LinearProfile
+{
+  static const Argument Type = DotProduct;
+  OT::Scalar operator()(const OT::Scalar t) const
+  {
+    return t;
+  }
+  void derivatives(const OT::Scalar t, OT::Scalar & f, OT::Scalar & f1, OT::Scalar & f2) const
+  {
+    f = t;
+    f1 = 1.0;
+    f2 = 0.0;
+  }
+  void transform(OT::Scalar *, const OT::UnsignedInteger) const
+  {
+    // Nothing to do
+  }
+};
+
+/* Values processed at once by the vectorized primitives */
+const OT::UnsignedInteger VectorBlockSize = 64;
+
+/* Whether the vectorized primitives may be used */
+inline OT::Bool UseVectorization()
+{
+  return OT::ResourceMap::GetAsBool("SVMKernel-UseVectorization") && SVMKernelVector::IsAvailable();
+}
+
+/* In-place kernel values of n arguments */
+template <class Profile>
+void ApplyProfile(const Profile & profile, OT::Scalar * values, const OT::UnsignedInteger n, const OT::Bool vectorized)
+{
+  if (!vectorized)
+  {
+    for (OT::UnsignedInteger i = 0; i < n; ++ i)
+      values[i] = profile(values[i]);
+    return;
+  }
+  // the primitives work on whole vectors, hence the local block
+  alignas(64) OT::Scalar block[VectorBlockSize] = {};
+  for (OT::UnsignedInteger i0 = 0; i0 < n; i0 += VectorBlockSize)
+  {
+    const OT::UnsignedInteger blockSize = std::min(VectorBlockSize, n - i0);
+    std::copy(values + i0, values + i0 + blockSize, block);
+    profile.transform(block, blockSize);
+    std::copy(block, block + blockSize, values + i0);
+  }
+}
+
+/* Squared distances of the pairs (x1_i, x2_j), i >= first(j), over a range of columns */
+struct SquaredDistancePolicy
+{
+  const OT::Sample & x1_;
+  const OT::Sample & x2_;
+  const SupportVectorMatrix & rows1_;
+  const SupportVectorMatrix & rows2_;
+  const OT::Indices & indices_;
+  const OT::Bool lowerOnly_;
+  const OT::Bool vectorized_;
+  OT::Scalar * values_;
+
+  SquaredDistancePolicy(const OT::Sample & x1,
+                        const OT::Sample & x2,
+                        const SupportVectorMatrix & rows1,
+                        const SupportVectorMatrix & rows2,
+                        const OT::Indices & indices,
+                        const OT::Bool lowerOnly,
+                        const OT::Bool vectorized,
+                        OT::Scalar * values)
+    : x1_(x1)
+    , x2_(x2)
+    , rows1_(rows1)
+    , rows2_(rows2)
+    , indices_(indices)
+    , lowerOnly_(lowerOnly)
+    , vectorized_(vectorized)
+    , values_(values)
+  {
+    // Nothing to do
+  }
+
+  inline void operator()(const OT::TBBImplementation::BlockedRange<OT::UnsignedInteger> & r) const
+  {
+    const OT::UnsignedInteger size1 = x1_.getSize();
+    const OT::UnsignedInteger dimension = x1_.getDimension();
+    const OT::UnsignedInteger stride = rows1_.getStride();
+    for (OT::UnsignedInteger j = r.begin(); j != r.end(); ++ j)
+    {
+      const OT::UnsignedInteger first = lowerOnly_ ? j : 0;
+      OT::Scalar * column = values_ + j * size1;
+      if (vectorized_)
+        SVMKernelVector::SquaredDistances(rows2_.data(j), rows1_.data(), stride, &indices_[first], size1 - first, column + first);
+      else
+        for (OT::UnsignedInteger i = first; i < size1; ++ i)
+        {
+          OT::Scalar r2 = 0.0;
+          for (OT::UnsignedInteger k = 0; k < dimension; ++ k)
+          {
+            const OT::Scalar delta = x1_(i, k) - x2_(j, k);
+            r2 += delta * delta;
+          }
+          column[i] = r2;
+        }
+    }
+  }
+}; /* end struct SquaredDistancePolicy */
+
+/* Profile applied in place to the values i >= first(j) of a range of columns */
+template <class Profile>
+struct ProfileColumnPolicy
+{
+  const Profile & profile_;
+  const OT::UnsignedInteger size1_;
+  const OT::Bool lowerOnly_;
+  const OT::Bool vectorized_;
+  OT::Scalar * values_;
+
+  ProfileColumnPolicy(const Profile & profile,
+                      const OT::UnsignedInteger size1,
+                      const OT::Bool lowerOnly,
+                      const OT::Bool vectorized,
+                      OT::Scalar * values)
+    : profile_(profile)
+    , size1_(size1)
+    , lowerOnly_(lowerOnly)
+    , vectorized_(vectorized)
+    , values_(values)
+  {
+    // Nothing to do
+  }
+
+  inline void operator()(const OT::TBBImplementation::BlockedRange<OT::UnsignedInteger> & r) const
+  {
+    for (OT::UnsignedInteger j = r.begin(); j != r.end(); ++ j)
+    {
+      const OT::UnsignedInteger first = lowerOnly_ ? j : 0;
+      ApplyProfile(profile_, values_ + j * size1_ + first, size1_ - first, vectorized_);
+    }
+  }
+}; /* end struct ProfileColumnPolicy */
+
+/* Arguments of the pairs (x1_i, x2_j), i >= first(j), into the column-major
+   array values of leading dimension n1 */
+template <class Profile>
+void ComputeProfileArguments(const OT::Sample & x1, const OT::Sample & x2,
+                             const OT::Bool lowerOnly, OT::Scalar * values)
+{
+  const OT::UnsignedInteger size1 = x1.getSize();
+  const OT::UnsignedInteger size2 = x2.getSize();
+  const OT::UnsignedInteger dimension = x1.getDimension();
+  if (Profile::Type == Distance)
+  {
+    // explicit differences over the padded rows
+    const SupportVectorMatrix rows1(x1);
+    const SupportVectorMatrix rows2(x2);
+    OT::Indices indices(size1);
+    indices.fill();
+    const SquaredDistancePolicy policy(x1, x2, rows1, rows2, indices, lowerOnly, UseVectorization(), values);
+    OT::TBBImplementation::ParallelFor(0, size2, policy);
+    return;
+  }
+
+  // dot products as one matrix product
+  OT::Matrix matrix1(size1, dimension);
+  OT::Matrix matrix2(size2, dimension);
+  OT::Point norms1(size1);
+  OT::Point norms2(size2);
+  for (OT::UnsignedInteger k = 0; k < dimension; ++ k)
+  {
+    for (OT::UnsignedInteger i = 0; i < size1; ++ i)
+    {
+      matrix1(i, k) = x1(i, k);
+      norms1[i] += x1(i, k) * x1(i, k);
+    }
+    for (OT::UnsignedInteger j = 0; j < size2; ++ j)
+    {
+      matrix2(j, k) = x2(j, k);
+      norms2[j] += x2(j, k) * x2(j, k);
+    }
+  }
+  const OT::Matrix products(matrix1.getImplementation()->genProd(*matrix2.getImplementation(), false, true));
+  for (OT::UnsignedInteger j = 0; j < size2; ++ j)
+    for (OT::UnsignedInteger i = (lowerOnly ? j : 0); i < size1; ++ i)
+    {
+      OT::Scalar argument = products(i, j);
+      if (Profile::Type == ExpandedDistance)
+        argument = std::max(norms1[i] + norms2[j] - 2.0 * argument, 0.0);
+      values[i + j * size1] = argument;
+    }
+}
+
+/* Cross-kernel matrix K_ij = k(x1_i, x2_j), the columns being processed in parallel */
+template <class Profile>
+OT::Matrix ComputeProfileCrossKernel(const Profile & profile, const OT::Sample & x1, const OT::Sample & x2)
+{
+  if (x1.getDimension() != x2.getDimension())
+    throw OT::InvalidArgumentException(HERE) << "The samples must have the same dimension, here " << x1.getDimension() << " and " << x2.getDimension();
+  const OT::UnsignedInteger size1 = x1.getSize();
+  const OT::UnsignedInteger size2 = x2.getSize();
+  OT::Matrix result(size1, size2);
+  if ((size1 == 0) || (size2 == 0))
+    return result;
+  OT::Scalar * values = &result(0, 0);
+  ComputeProfileArguments<Profile>(x1, x2, false, values);
+  const ProfileColumnPolicy<Profile> policy(profile, size1, false, UseVectorization(), values);
+  OT::TBBImplementation::ParallelFor(0, size2, policy);
+  return result;
+}
+
+/* Gram matrix K_ij = k(x_i, x_j), only the lower triangle being evaluated */
+template <class Profile>
+OT::SymmetricMatrix ComputeProfileGram(const Profile & profile, const OT::Sample & x)
+{
+  const OT::UnsignedInteger size = x.getSize();
+  OT::SymmetricMatrix result(size);
+  if (size == 0)
+    return result;
+  OT::Scalar * values = &result(0, 0);
+  ComputeProfileArguments<Profile>(x, x, true, values);
+  const ProfileColumnPolicy<Profile> policy(profile, size, true, UseVectorization(), values);
+  OT::TBBImplementation::ParallelFor(0, size, policy);
+  return result;
+}
+
+}
+
+#endif /* OTSVM_SVMKERNELPROFILE_HXX */
@@ -23,6 +23,7 @@
 #define OPENTURNS_SVMKERNELREGRESSIONEVALUATION_HXX
 
 #include "SVMKernel.hxx"
+#include "SupportVectorMatrix.hxx"
 #include <openturns/EvaluationImplementation.hxx>
 #include "SVMKernelRegressionGradient.hxx"
 #include "SVMKernelRegressionHessian.hxx"
@@ -30,6 +31,8 @@
 namespace OTSVM
 {
 
+class SVMKernelEngine;
+
 
 /**
  * @class SVMKernelRegressionEvaluation
@@ -51,7 +54,7 @@ public:
   /** Constructor with parameters */
   SVMKernelRegressionEvaluation(const SVMKernel & kernel,
                                 const OT::Point & lagrangeMultiplier,
-                                const OT::Sample & dataIn,
+                                const SupportVectorMatrix & supportVectors,
                                 const OT::Scalar constant);
 
   /** Virtual constructor */
@@ -65,6 +68,16 @@ public:
 
   /** Operator () */
   OT::Point operator() (const OT::Point & inP) const override;
+  OT::Sample operator() (const OT::Sample & inS) const override;
+
+  /** Value and gradient in a single pass over the support vectors */
+  OT::Point computeValueAndGradient(const OT::Point & inP,
+                                    OT::Matrix & gradient) const;
+
+  /** Value, gradient and hessian in a single pass over the support vectors */
+  OT::Point computeValueAndDerivatives(const OT::Point & inP,
+                                       OT::Matrix & gradient,
+                                       OT::SymmetricTensor & hessian) const;
 
   /** Accessor for input point dimension */
   OT::UnsignedInteger getInputDimension() const override;
@@ -86,9 +99,13 @@ private:
 protected:
   SVMKernel kernel_;
   OT::Point lagrangeMultiplier_;
-  OT::Sample dataIn_;
+  SupportVectorMatrix supportVectors_;
   OT::Scalar constant_;
 
+private:
+  /* Kernel-specialized expansion, rebuilt from the attributes above */
+  OT::Pointer<SVMKernelEngine> p_engine_;
+
 }; /* class SVMKernelRegressionEvaluation */
 
 
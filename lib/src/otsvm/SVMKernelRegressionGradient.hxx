@@ -23,6 +23,7 @@
 #define OTSVM_SVMKERNELREGRESSIONGRADIENT_HXX
 
 #include "SVMKernel.hxx"
+#include "SupportVectorMatrix.hxx"
 #include <openturns/GradientImplementation.hxx>
 #include "SVMKernelRegressionEvaluation.hxx"
 #include <openturns/Sample.hxx>
@@ -31,6 +32,8 @@
 namespace OTSVM
 {
 
+class SVMKernelEngine;
+
 class SVMKernelRegressionEvaluation;
 
 /**
@@ -53,7 +56,7 @@ public:
   /** Constructor with parameters */
   SVMKernelRegressionGradient(const SVMKernel & kernel,
                               const OT::Point & lagrangeMultiplier,
-                              const OT::Sample & dataIn,
+                              const SupportVectorMatrix & supportVectors,
                               const OT::Scalar constant);
 
   /** Virtual constructor */
@@ -68,6 +71,9 @@ public:
   /** Gradient method */
   OT::Matrix gradient(const OT::Point & inP) const override;
 
+  /** Gradients over a sample: row i holds the gradient at the i-th point */
+  OT::Sample gradient(const OT::Sample & inS) const;
+
   /** Accessor for input point dimension */
   OT::UnsignedInteger getInputDimension() const override;
 
@@ -85,9 +91,13 @@ private:
 protected:
   SVMKernel kernel_;
   OT::Point lagrangeMultiplier_;
-  OT::Sample dataIn_;
+  SupportVectorMatrix supportVectors_;
   OT::Scalar constant_;
 
+private:
+  /* Kernel-specialized expansion, rebuilt from the attributes above */
+  OT::Pointer<SVMKernelEngine> p_engine_;
+
 }; /* class SVMKernelRegressionGradient */
 
 
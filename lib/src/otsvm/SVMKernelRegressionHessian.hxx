@@ -23,6 +23,7 @@
 #define OTSVM_SVMKERNELREGRESSIONHESSIAN_HXX
 
 #include "SVMKernel.hxx"
+#include "SupportVectorMatrix.hxx"
 #include <openturns/HessianImplementation.hxx>
 #include "SVMKernelRegressionEvaluation.hxx"
 #include <openturns/Sample.hxx>
@@ -31,6 +32,8 @@
 namespace OTSVM
 {
 
+class SVMKernelEngine;
+
 class SVMKernelRegressionEvaluation;
 
 /**
@@ -52,7 +55,7 @@ public:
   /** Constructor with parameters */
   SVMKernelRegressionHessian(const SVMKernel & kernel,
                              const OT::Point & lagrangeMultiplier,
-                             const OT::Sample & dataIn,
+                             const SupportVectorMatrix & supportVectors,
                              const OT::Scalar constant);
 
   /** Virtual constructor */
@@ -83,9 +86,13 @@ private:
 protected:
   SVMKernel kernel_;
   OT::Point lagrangeMultiplier_;
-  OT::Sample dataIn_;
+  SupportVectorMatrix supportVectors_;
   OT::Scalar constant_;
 
+private:
+  /* Kernel-specialized expansion, rebuilt from the attributes above */
+  OT::Pointer<SVMKernelEngine> p_engine_;
+
 }; /* class SVMKernelRegressionHessian */
 
 
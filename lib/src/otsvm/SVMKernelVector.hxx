@@ -0,0 +1,96 @@
+//                                               -*- C++ -*-
+/**
+ *  @brief Vectorized block primitives of the kernel expansions
+ *
+ *  Copyright 2014-2024 Phimeca
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OTSVM_SVMKERNELVECTOR_HXX
+#define OTSVM_SVMKERNELVECTOR_HXX
+
+#include <openturns/OTprivate.hxx>
+#include "otsvm/OTSVMprivate.hxx"
+
+namespace OTSVM
+{
+
+/**
+ * @class SVMKernelVector
+ *
+ * AVX2 or AVX-512 implementations of the inner loops of the kernel
+ * expansions, selected once at runtime from the CPU features.
+ * When neither is available IsAvailable() is false and callers keep their
+ * scalar loops.
+ *
+ * Accuracy with respect to the libm functions:
+ * - Exp is within 2 ULP above -708; below it returns 0, which differs
+ *   from exp by less than exp(-708) = 3.3e-308,
+ * - Tanh is within 4 ULP,
+ * - Dots and SquaredDistances sum the components in another order than
+ *   the scalar loops; SquaredDistances uses the explicit differences, so
+ *   the squared distance r2 in dimension d is within d eps r2 of the one of
+ *   operator().
+ * So a NormalRBF term exp(-r2 / (2 sigma^2)) differs from
+ * NormalRBF::operator() by at most 2 ULP plus a relative
+ * d eps r2 / (2 sigma^2), which is negligible where the term matters.
+ * This does not hold for the expanded distance |x|^2 + |y|^2 - 2 x.y of
+ * the Gram matrices, whose absolute error eps (|x|^2 + |y|^2) on r2 gives a
+ * relative error of about eps (|x|^2 + |y|^2) / (2 sigma^2) on the term.
+ *
+ * Rows are read over their whole stride, which must be a multiple of 8
+ * and zero-padded, and blocks of values are processed by whole vectors:
+ * the arrays must hold n rounded up to a multiple of 8.
+ * This header is not installed.
+ */
+class OTSVM_LOCAL SVMKernelVector
+{
+public:
+
+  /** Whether a vectorized instruction set was detected */
+  static OT::Bool IsAvailable();
+
+  /** Name of the selected instruction set: avx512, avx2 or none */
+  static OT::String GetInstructionSet();
+
+  /** out[j] = x.data[rows[j]] for j < n */
+  static void Dots(const OT::Scalar * x,
+                   const OT::Scalar * data,
+                   const OT::UnsignedInteger stride,
+                   const OT::UnsignedInteger * rows,
+                   const OT::UnsignedInteger n,
+                   OT::Scalar * out);
+
+  /** out[j] = |x - data[rows[j]]|^2 for j < n */
+  static void SquaredDistances(const OT::Scalar * x,
+                               const OT::Scalar * data,
+                               const OT::UnsignedInteger stride,
+                               const OT::UnsignedInteger * rows,
+                               const OT::UnsignedInteger n,
+                               OT::Scalar * out);
+
+  /** In-place exponential of n values */
+  static void Exp(OT::Scalar * values, const OT::UnsignedInteger n);
+
+  /** In-place hyperbolic tangent of n values */
+  static void Tanh(OT::Scalar * values, const OT::UnsignedInteger n);
+
+}; /* class SVMKernelVector */
+
+
+}
+
+#endif /* OTSVM_SVMKERNELVECTOR_HXX */
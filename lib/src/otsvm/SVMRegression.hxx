@@ -47,6 +47,11 @@ public:
                    const OT::Sample & dataOut,
                    const LibSVM::KernelType kerneltype = LibSVM::NormalRbf);
 
+  /* constructor with any kernel, trained through its Gram matrix */
+  SVMRegression(const OT::Sample & dataIn,
+                   const OT::Sample & dataOut,
+                   const SVMKernel & kernel);
+
   /* Virtual constructor*/
   SVMRegression * clone() const override;
 
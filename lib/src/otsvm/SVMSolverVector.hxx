@@ -0,0 +1,54 @@
+//                                               -*- C++ -*-
+/**
+ *  @brief Vectorized loops of the solver of the bundled libsvm
+ *
+ *  Copyright 2014-2024 Phimeca
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OTSVM_SVMSOLVERVECTOR_HXX
+#define OTSVM_SVMSOLVERVECTOR_HXX
+
+#include <openturns/OTprivate.hxx>
+#include "otsvm/OTSVMprivate.hxx"
+
+struct svm_solver_loops;
+
+namespace OTSVM
+{
+
+/**
+ * @class SVMSolverVector
+ *
+ * Loops of the working set selection and of the gradient update of the
+ * bundled libsvm solver, compiled for the instruction set selected by
+ * SVMKernelVector: the scans in AVX2, the update in AVX2 or AVX-512.
+ * Every value is rounded as in the scalar loops of svm.cpp and the ties go
+ * to the last index, so the solver selects the same working sets.
+ * This header is not installed.
+ */
+class OTSVM_LOCAL SVMSolverVector
+{
+public:
+
+  /** Loops to set as svm_parameter::solver_loops, null without AVX2 */
+  static const svm_solver_loops * GetLoops();
+
+}; /* class SVMSolverVector */
+
+}
+
+#endif /* OTSVM_SVMSOLVERVECTOR_HXX */
@@ -0,0 +1,106 @@
+//                                               -*- C++ -*-
+/**
+ *  @brief Packed storage of the support vectors of a kernel expansion
+ *
+ *  Copyright 2014-2024 Phimeca
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OTSVM_SUPPORTVECTORMATRIX_HXX
+#define OTSVM_SUPPORTVECTORMATRIX_HXX
+
+#include <openturns/Sample.hxx>
+#include "otsvm/OTSVMprivate.hxx"
+
+#include <vector>
+
+namespace OTSVM
+{
+
+/**
+ * @class SupportVectorMatrix
+ *
+ * Row-major, cache-aligned copy of the support vectors, so that kernels
+ * can work on raw rows instead of Points.
+ * The packed rows are immutable and shared between copies.
+ */
+class OTSVM_API SupportVectorMatrix
+  : public OT::PersistentObject
+{
+  CLASSNAME
+
+public:
+
+  /** Alignment of the rows, in bytes */
+  static const OT::UnsignedInteger Alignment = 64;
+
+  /** Default constructor */
+  SupportVectorMatrix();
+
+  /** Constructor from the support vectors */
+  SupportVectorMatrix(const OT::Sample & supportVectors);
+
+  /** Virtual constructor */
+  SupportVectorMatrix * clone() const override;
+
+  /** Comparison operator */
+  OT::Bool operator ==(const SupportVectorMatrix & other) const;
+
+  /** String converter */
+  OT::String __repr__() const override;
+
+  /** Number of support vectors */
+  OT::UnsignedInteger getSize() const;
+
+  /** Dimension of the support vectors */
+  OT::UnsignedInteger getDimension() const;
+
+  /** Distance between two consecutive rows, in number of scalars */
+  OT::UnsignedInteger getStride() const;
+
+  /** Aligned pointer to the first row */
+  const OT::Scalar * data() const;
+
+  /** Aligned pointer to the given row */
+  const OT::Scalar * data(const OT::UnsignedInteger index) const;
+
+  /** Support vectors as a Sample */
+  OT::Sample getSample() const;
+
+  /** Method save() stores the object through the StorageManager */
+  void save(OT::Advocate & adv) const override;
+
+  /** Method load() reloads the object from the StorageManager */
+  void load(OT::Advocate & adv) override;
+
+private:
+
+  void pack(const OT::Sample & supportVectors);
+
+  OT::UnsignedInteger size_ = 0;
+  OT::UnsignedInteger dimension_ = 0;
+  OT::UnsignedInteger stride_ = 0;
+
+  /* Shared storage, data_ points to its first aligned element */
+  OT::Pointer<std::vector<OT::Scalar> > p_buffer_;
+  const OT::Scalar * data_ = nullptr;
+
+}; /* class SupportVectorMatrix */
+
+
+}
+
+#endif /* OTSVM_SUPPORTVECTORMATRIX_HXX */
@@ -0,0 +1,156 @@
+//                                               -*- C++ -*-
+/**
+ *  @brief The test file for the bundled libsvm solver.
+ *
+ *  Copyright 2014-2024 Phimeca
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ */
+#include <openturns/OT.hxx>
+#include <openturns/OTtestcode.hxx>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include "otsvm/svm.h"
+
+using namespace OT;
+using namespace OT::Test;
+
+
+/* Worst case scheduler: all the bodies run at once */
+void ParallelFor(int n, void (*body)(int, void *), void * data)
+{
+  std::vector<std::thread> threads;
+  for (int k = 0; k < n; ++ k)
+    threads.push_back(std::thread(body, k, data));
+  for (int k = 0; k < n; ++ k)
+    threads[k].join();
+}
+
+/* Coefficients of the support vectors of all the classifiers */
+Point coefficients(const svm_model * model)
+{
+  Point coef;
+  for (int m = 0; m < model->nr_class - 1; ++ m)
+    for (int k = 0; k < model->l; ++ k)
+      coef.add(model->sv_coef[m][k]);
+  return coef;
+}
+
+/* Same support vectors, coefficients and constants */
+Bool same(const svm_model * model1, const svm_model * model2)
+{
+  if ((model1->l != model2->l) || (coefficients(model1) != coefficients(model2)))
+    return false;
+  for (int k = 0; k < model1->l; ++ k)
+    if (model1->sv_indices[k] != model2->sv_indices[k])
+      return false;
+  for (int m = 0; m < model1->nr_class * (model1->nr_class - 1) / 2; ++ m)
+    if (model1->rho[m] != model2->rho[m])
+      return false;
+  return true;
+}
+
+int main(int /*argc*/, char ** /*argv*/)
+{
+  // 4 overlapping classes: 6 one-vs-one classifiers of 1000 points
+  const UnsignedInteger classNumber = 4;
+  const UnsignedInteger classSize = 500;
+  const UnsignedInteger size = classNumber * classSize;
+  RandomGenerator::SetSeed(0);
+  const Sample sample(Normal(2).getSample(size));
+  std::vector<svm_node> node(3 * size);
+  std::vector<svm_node *> x(size);
+  std::vector<double> y(size);
+  for (UnsignedInteger i = 0; i < size; ++ i)
+  {
+    const UnsignedInteger label = i / classSize;
+    node[3 * i].index = 1;
+    node[3 * i].value = sample(i, 0) + label;
+    node[3 * i + 1].index = 2;
+    node[3 * i + 1].value = sample(i, 1) + 0.5 * label;
+    node[3 * i + 2].index = -1;
+    x[i] = &node[3 * i];
+    y[i] = label;
+  }
+  svm_problem problem;
+  problem.l = size;
+  problem.x = x.data();
+  problem.y = y.data();
+
+  svm_parameter parameter;
+  std::memset(&parameter, 0, sizeof(parameter));
+  parameter.svm_type = C_SVC;
+  parameter.kernel_type = RBF;
+  parameter.gamma = 0.5;
+  parameter.C = 10.0;
+  parameter.eps = 1e-3;
+  parameter.shrinking = 1;
+  parameter.nr_thread = 4;
+  parameter.cache_type = CACHE_FLOAT;
+  // room for about 15 columns in each of the 4 solvers
+  parameter.cache_size = 0.25;
+  if (svm_check_parameter(&problem, &parameter))
+    throw TestFailed(svm_check_parameter(&problem, &parameter));
+
+  svm_model * serial = svm_train(&problem, &parameter);
+
+  // the classifiers trained at once share the cache budget
+  parameter.parallel_for = &ParallelFor;
+  svm_cache_peak();
+  svm_model * parallel = svm_train(&problem, &parameter);
+  const size_t peak = svm_cache_peak();
+  const size_t budget = parameter.cache_size * (1 << 20);
+  if (peak > budget)
+    throw TestFailed(OSS() << "the kernel caches hold " << peak << " bytes at once, more than the budget of " << budget);
+
+  // the scheduling does not change the classifiers
+  if (!same(parallel, serial))
+    throw TestFailed("the classifiers must not depend on the scheduling");
+  svm_free_and_destroy_model(&serial);
+  svm_free_and_destroy_model(&parallel);
+
+  // a regression of 33000 variables, scanned in 2 blocks, on 200 distinct
+  // points repeated across the blocks: the working set is selected among
+  // many ties, as in the serial scan
+  const UnsignedInteger regressionSize = 16500;
+  node.resize(2 * regressionSize);
+  x.resize(regressionSize);
+  y.resize(regressionSize);
+  for (UnsignedInteger i = 0; i < regressionSize; ++ i)
+  {
+    node[2 * i].index = 1;
+    node[2 * i].value = (i % 200) / 40.0;
+    node[2 * i + 1].index = -1;
+    x[i] = &node[2 * i];
+    y[i] = std::sin(node[2 * i].value);
+  }
+  problem.l = regressionSize;
+  problem.x = x.data();
+  problem.y = y.data();
+  parameter.svm_type = EPSILON_SVR;
+  parameter.gamma = 1.0;
+  parameter.C = 100.0;
+  parameter.p = 1e-3;
+  parameter.cache_size = 100.0;
+  parameter.nr_thread = 1;
+  parameter.parallel_for = nullptr;
+  serial = svm_train(&problem, &parameter);
+  parameter.nr_thread = 4;
+  parameter.parallel_for = &ParallelFor;
+  parallel = svm_train(&problem, &parameter);
+  if (!same(parallel, serial))
+    throw TestFailed("the regression must not depend on the blocks of the solver");
+  svm_free_and_destroy_model(&serial);
+  svm_free_and_destroy_model(&parallel);
+  return ExitCode::Success;
+}
@@ -0,0 +1,158 @@
+//                                               -*- C++ -*-
+/**
+ *  @brief The test file of class SVMKernelRegressionEvaluation
+ *
+ *  Copyright 2014-2024 Phimeca
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <openturns/OTtestcode.hxx>
+#include <openturns/OStream.hxx>
+#include <openturns/Normal.hxx>
+#include <openturns/ResourceMap.hxx>
+#include "otsvm/OTSVM.hxx"
+#include "otsvm/SVMKernelRegressionEvaluation.hxx"
+#include "otsvm/SVMKernelRegressionGradient.hxx"
+#include "otsvm/SVMKernelRegressionHessian.hxx"
+
+using namespace OT;
+using namespace OT::Test;
+using namespace OTSVM;
+
+/* A user-defined kernel must go through the virtual interface */
+class ShiftedRBF : public NormalRBF
+{
+public:
+  ShiftedRBF() : NormalRBF(1.5) {}
+  ShiftedRBF * clone() const override
+  {
+    return new ShiftedRBF(*this);
+  }
+  Scalar operator() (const Point & x1, const Point & x2) const override
+  {
+    return NormalRBF::operator()(x1, x2) + 0.5;
+  }
+};
+
+int main(void)
+{
+  TESTPREAMBLE;
+  try
+  {
+    Collection<SVMKernel> kernels;
+    kernels.add(NormalRBF(2.0));
+    kernels.add(ExponentialRBF(2.0));
+    kernels.add(LinearKernel());
+    kernels.add(PolynomialKernel(3.0, 2.0, 1.0));
+    kernels.add(RationalKernel(2.0));
+    kernels.add(SigmoidKernel(0.5, 0.1));
+    kernels.add(ShiftedRBF());
+
+    RandomGenerator::SetSeed(0);
+    const UnsignedInteger dimension = 3;
+    const Sample supportVectors(Normal(dimension).getSample(50));
+    Point coefficients(Normal().getSample(50).getImplementation()->getData());
+    coefficients[7] = 0.0;
+    const Scalar constant = 0.25;
+    Sample X(Normal(dimension).getSample(20));
+    // the expansion must also be exact on the support vectors themselves
+    X.add(supportVectors[3]);
+
+    // both the SIMD and the scalar loops must match the kernels
+    for (UnsignedInteger vectorization = 0; vectorization < 2; ++ vectorization)
+    {
+      ResourceMap::SetAsBool("SVMKernel-UseVectorization", vectorization == 1);
+      for (UnsignedInteger i = 0; i < kernels.getSize(); ++ i)
+      {
+        const SVMKernel kernel(kernels[i]);
+        const SVMKernelRegressionEvaluation evaluation(kernel, coefficients, supportVectors, constant);
+        const Sample Y(evaluation(X));
+        for (UnsignedInteger j = 0; j < X.getSize(); ++ j)
+        {
+          Scalar reference = constant;
+          for (UnsignedInteger k = 0; k < supportVectors.getSize(); ++ k)
+            reference += coefficients[k] * kernel(supportVectors[k], X[j]);
+          assert_almost_equal(evaluation(X[j])[0], reference, 1e-12, 1e-12);
+          assert_almost_equal(Y(j, 0), evaluation(X[j])[0], 0.0, 0.0);
+        }
+      }
+    }
+
+    // the fused derivatives must match the kernel partial derivatives
+    for (UnsignedInteger i = 0; i < kernels.getSize(); ++ i)
+    {
+      const SVMKernel kernel(kernels[i]);
+      const SVMKernelRegressionEvaluation evaluation(kernel, coefficients, supportVectors, constant);
+      const SVMKernelRegressionGradient gradient(kernel, coefficients, supportVectors, constant);
+      const SVMKernelRegressionHessian hessian(kernel, coefficients, supportVectors, constant);
+      const Sample gradients(gradient.gradient(X));
+      for (UnsignedInteger j = 0; j < X.getSize(); ++ j)
+      {
+        Point referenceGradient(dimension);
+        SymmetricMatrix referenceHessian(dimension);
+        for (UnsignedInteger k = 0; k < supportVectors.getSize(); ++ k)
+        {
+          referenceGradient += coefficients[k] * kernel.partialGradient(X[j], supportVectors[k]);
+          referenceHessian = referenceHessian + coefficients[k] * kernel.partialHessian(X[j], supportVectors[k]);
+        }
+        Matrix fusedGradient;
+        SymmetricTensor fusedHessian;
+        const Point value(evaluation.computeValueAndDerivatives(X[j], fusedGradient, fusedHessian));
+        assert_almost_equal(value, evaluation(X[j]), 1e-12, 1e-12);
+        const Matrix gradientJ(gradient.gradient(X[j]));
+        const SymmetricTensor hessianJ(hessian.hessian(X[j]));
+        for (UnsignedInteger k = 0; k < dimension; ++ k)
+        {
+          assert_almost_equal(gradientJ(k, 0), referenceGradient[k], 1e-10, 1e-10);
+          assert_almost_equal(fusedGradient(k, 0), gradientJ(k, 0), 0.0, 0.0);
+          assert_almost_equal(gradients(j, k), gradientJ(k, 0), 1e-10, 1e-10);
+          for (UnsignedInteger l = 0; l <= k; ++ l)
+          {
+            assert_almost_equal(hessianJ(k, l, 0), referenceHessian(k, l), 1e-10, 1e-10);
+            assert_almost_equal(fusedHessian(k, l, 0), hessianJ(k, l, 0), 0.0, 0.0);
+          }
+        }
+      }
+    }
+
+    // the batch evaluation does not depend on the number of threads
+    const SVMKernelRegressionEvaluation evaluation(kernels[0], coefficients, supportVectors, constant);
+    const Sample bigX(Normal(dimension).getSample(1000));
+    ResourceMap::SetAsUnsignedInteger("SVMRegression-PredictionThreads", 1);
+    const Sample sequential(evaluation(bigX));
+    ResourceMap::SetAsUnsignedInteger("SVMRegression-PredictionThreads", 7);
+    const Sample parallel(evaluation(bigX));
+    for (UnsignedInteger j = 0; j < bigX.getSize(); ++ j)
+      assert_almost_equal(parallel(j, 0), sequential(j, 0), 0.0, 0.0);
+
+    // nor does the batch gradient
+    const SVMKernelRegressionGradient gradient(kernels[0], coefficients, supportVectors, constant);
+    ResourceMap::SetAsUnsignedInteger("SVMRegression-PredictionThreads", 1);
+    const Sample sequentialGradients(gradient.gradient(bigX));
+    ResourceMap::SetAsUnsignedInteger("SVMRegression-PredictionThreads", 7);
+    const Sample parallelGradients(gradient.gradient(bigX));
+    for (UnsignedInteger j = 0; j < bigX.getSize(); ++ j)
+      for (UnsignedInteger k = 0; k < dimension; ++ k)
+        assert_almost_equal(parallelGradients(j, k), sequentialGradients(j, k), 0.0, 0.0);
+  }
+  catch (TestFailed & ex)
+  {
+    std::cerr << ex << std::endl;
+    return ExitCode::Error;
+  }
+
+  return ExitCode::Success;
+
+}
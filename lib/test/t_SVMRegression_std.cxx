@@ -26,6 +26,16 @@ using namespace OT::Test;
 using namespace OTSVM;
 
 
+/* Predictions of a regression over the given grid */
+Sample train(const Sample & dataIn, const Sample & dataOut, const Point & cp, const Point & gamma)
+{
+  OTSVM::SVMRegression regression(dataIn, dataOut, LibSVM::NormalRbf);
+  regression.setTradeoffFactor(cp);
+  regression.setKernelParameter(gamma);
+  regression.run();
+  return regression.getResult().getMetaModel()(dataIn);
+}
+
 int main(int /*argc*/, char ** /*argv*/)
 {
 
@@ -39,6 +49,9 @@ int main(int /*argc*/, char ** /*argv*/)
   }
 
 
+  // the folds of the cross validation are drawn from the OpenTURNS generator
+  RandomGenerator::SetSeed(0);
+
   const Point cp = {5.0, 10.0};
   const Point gamma = {0.001, 0.1, 10.0, 100.0, 1.0};
 
@@ -52,7 +65,17 @@ int main(int /*argc*/, char ** /*argv*/)
   const MetaModelResult result(regression.getResult());
   std::cout << "result=" << result << std::endl;
 
-  MetaModelValidation validation(dataOut, result.getMetaModel()(dataIn));
+  const Function metaModel(result.getMetaModel());
+  const Sample predicted(metaModel(dataIn));
+
+  // both outputs select C=10 and sigma=1, the model being the one of this cell alone
+  assert_almost_equal(predicted, train(dataIn, dataOut, Point(1, 10.0), Point(1, 1.0)), 1e-12, 1e-12);
+
+  MetaModelValidation validation(dataOut, predicted);
   const Point mse = validation.computeMeanSquaredError();
   assert_almost_equal(mse, {0.00383302, 0.000958254}, 1e-5, 2e-4);
+
+  // the sample evaluation must agree with the point-wise one
+  for (UnsignedInteger i = 0; i < dataIn.getSize(); ++ i)
+    assert_almost_equal(predicted[i], metaModel(dataIn[i]), 1e-12, 1e-12);
 }
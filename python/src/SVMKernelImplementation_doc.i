@@ -55,3 +55,43 @@ Returns
 hessian : :class:`openturns.SymmetricMatrix`
     Hessian value
 "
+
+// ---------------------------------------------------------------------
+
+%feature("docstring") OTSVM::SVMKernelImplementation::computeGram
+"Gram matrix accessor.
+
+Parameters
+----------
+x : 2-d sequence of float
+    Points :math:`x_i`
+
+Returns
+-------
+gram : :class:`openturns.SymmetricMatrix`
+    Matrix :math:`K_{ij} = k(x_i, x_j)`
+
+Notes
+-----
+The built-in kernels use specialized loops. Any other kernel, including a
+class derived from a built-in one, is evaluated pair by pair through its call
+operator from several threads, which must then be thread-safe.
+"
+
+// ---------------------------------------------------------------------
+
+%feature("docstring") OTSVM::SVMKernelImplementation::computeCrossKernel
+"Cross-kernel matrix accessor.
+
+Parameters
+----------
+x1 : 2-d sequence of float
+    Points :math:`x^{(1)}_i`
+x2 : 2-d sequence of float
+    Points :math:`x^{(2)}_j`, same dimension as `x1`
+
+Returns
+-------
+cross : :class:`openturns.Matrix`
+    Matrix :math:`K_{ij} = k(x^{(1)}_i, x^{(2)}_j)`
+"
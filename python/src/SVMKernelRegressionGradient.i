@@ -0,0 +1,11 @@
+// SWIG file SVMKernelRegressionGradient.i
+
+%{
+#include "otsvm/SVMKernelRegressionGradient.hxx"
+%}
+
+%include SVMKernelRegressionGradient_doc.i
+
+%copyctor OTSVM::SVMKernelRegressionGradient;
+
+%include otsvm/SVMKernelRegressionGradient.hxx
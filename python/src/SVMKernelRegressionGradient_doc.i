@@ -0,0 +1,34 @@
+%feature("docstring") OTSVM::SVMKernelRegressionGradient
+"Gradient of a support vector regression.
+
+The gradient with respect to :math:`x` of the expansion
+:math:`f(x) = b + c_1 k(x, sv_1) + ... + c_n k(x, sv_n)`.
+
+Parameters
+----------
+kernel : :class:`~otsvm.SVMKernel`
+    Kernel
+lagrangeMultiplier : sequence of float
+    Coefficients :math:`c_j` of the support vectors
+supportVectors : :class:`~otsvm.SupportVectorMatrix`
+    Support vectors :math:`sv_j`
+constant : float
+    Constant :math:`b`
+"
+
+// ---------------------------------------------------------------------
+
+%feature("docstring") OTSVM::SVMKernelRegressionGradient::gradient
+"Gradient accessor.
+
+Parameters
+----------
+x : sequence of float or 2-d sequence of float
+    Input point or sample
+
+Returns
+-------
+gradient : :class:`openturns.Matrix` or :class:`openturns.Sample`
+    Gradient at the point, as a column matrix, or gradients at the points
+    of the sample, one per row
+"
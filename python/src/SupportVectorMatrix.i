@@ -0,0 +1,13 @@
+// SWIG file SupportVectorMatrix.i
+
+%{
+#include "otsvm/SupportVectorMatrix.hxx"
+%}
+
+%include SupportVectorMatrix_doc.i
+
+%ignore OTSVM::SupportVectorMatrix::data;
+
+%copyctor OTSVM::SupportVectorMatrix;
+
+%include otsvm/SupportVectorMatrix.hxx
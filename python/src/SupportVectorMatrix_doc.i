@@ -0,0 +1,19 @@
+%feature("docstring") OTSVM::SupportVectorMatrix
+"Packed storage of the support vectors of a kernel expansion.
+
+Parameters
+----------
+supportVectors : 2-d sequence of float
+    Support vectors, one per row
+"
+
+// ---------------------------------------------------------------------
+
+%feature("docstring") OTSVM::SupportVectorMatrix::getSample
+"Support vectors accessor.
+
+Returns
+-------
+supportVectors : :class:`openturns.Sample`
+    Support vectors, one per row
+"
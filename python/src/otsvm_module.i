@@ -26,6 +26,8 @@
 %include PolynomialKernel.i
 %include SigmoidKernel.i
 %include LinearKernel.i
+%include SupportVectorMatrix.i
+%include SVMKernelRegressionGradient.i
 %include LibSVM.i
 %include SVMRegression.i
 %include SVMClassification.i
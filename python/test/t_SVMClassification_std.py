@@ -37,6 +37,13 @@ for i in range(10):
     c = dataOut[i]
     print(f"x={x} c={c} classify={algo.classify(x)} grade={algo.grade(x, c)} predict={algo.predict(x)}")
 
+# batch classification
+classes = algo.classify(dataIn)
+grades = algo.grade(dataIn, dataOut)
+for i in range(size):
+    assert classes[i] == algo.classify(dataIn[i]), "classify"
+    assert grades[i] == algo.grade(dataIn[i], dataOut[i]), "grade"
+
 algo.setWeight([1.0] * size)
 
 algo.runKMeans(2)
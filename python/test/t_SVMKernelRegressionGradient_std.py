@@ -0,0 +1,33 @@
+#! /usr/bin/env python
+
+import openturns as ot
+import openturns.testing as ott
+import otsvm
+
+ot.RandomGenerator.SetSeed(0)
+dimension = 3
+supportVectors = ot.Normal(dimension).getSample(50)
+coefficients = ot.Normal().getSample(50).asPoint()
+x = ot.Normal(dimension).getSample(20)
+# the gradient must also be exact on the support vectors themselves
+x.add(supportVectors[3])
+
+kernels = [
+    otsvm.NormalRBF(2.0),
+    otsvm.ExponentialRBF(2.0),
+    otsvm.PolynomialKernel(3.0, 2.0, 1.0),
+    otsvm.SigmoidKernel(0.5, 0.1),
+]
+
+for kernel in kernels:
+    gradient = otsvm.SVMKernelRegressionGradient(
+        kernel, coefficients, otsvm.SupportVectorMatrix(supportVectors), 0.25
+    )
+    # one row per point, equal to the point-wise gradient
+    gradients = gradient.gradient(x)
+    assert gradients.getSize() == x.getSize(), "wrong number of gradients"
+    assert gradients.getDimension() == dimension, "wrong gradient dimension"
+    for i in range(x.getSize()):
+        gradientI = gradient.gradient(x[i])
+        reference = [gradientI[k, 0] for k in range(dimension)]
+        ott.assert_almost_equal(gradients[i], reference, 1e-10, 1e-10)
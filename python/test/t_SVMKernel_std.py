@@ -47,6 +47,27 @@ for kernel in kernels:
         kxydx2 = kernel.partialHessian(x, y)
         print("d2kernel/(dx_i*dx_j)(x,y)=", repr(kxydx2))
 
+        # check hessian by finite diff of the gradient
+        kxydx2fd = ot.SymmetricMatrix(2)
+        for j in range(2):
+            xh = list(x)
+            xh[j] += h
+            kxydxh = kernel.partialGradient(xh, y)
+            for i in range(j, 2):
+                kxydx2fd[i, j] = (kxydxh[i] - kxydx[i]) / h
+        ott.assert_almost_equal(kxydx2, kxydx2fd, 1e-5, 1e-5)
+
+    # Gram and cross-kernel matrices
+    x1 = ot.Normal(3).getSample(7)
+    x2 = ot.Normal(3).getSample(5)
+    gram = kernel.computeGram(x1)
+    cross = kernel.computeCrossKernel(x1, x2)
+    for i in range(len(x1)):
+        for j in range(i + 1):
+            ott.assert_almost_equal(gram[i, j], kernel(x1[i], x1[j]), 1e-12, 1e-12)
+        for j in range(len(x2)):
+            ott.assert_almost_equal(cross[i, j], kernel(x1[i], x2[j]), 1e-12, 1e-12)
+
     # parameter accessor
     param = kernel.getParameter()
     desc = kernel.getParameterDescription()
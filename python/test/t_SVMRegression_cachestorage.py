@@ -0,0 +1,37 @@
+#! /usr/bin/env python
+
+import openturns as ot
+import openturns.testing as ott
+import otsvm
+from math import pi
+
+# Ishigami function
+inputVariables = ["xi1", "xi2", "xi3"]
+model = ot.SymbolicFunction(
+    inputVariables, ["sin(xi1) + 7.0 * sin(xi2)^2 + 0.1 * xi3^4 * sin(xi1)"]
+)
+distribution = ot.JointDistribution([ot.Uniform(-pi, pi)] * 3)
+ot.RandomGenerator.SetSeed(0)
+dataIn = distribution.getSample(250)
+dataOut = model(dataIn)
+
+
+def trainingError(storage):
+    ot.ResourceMap.SetAsString("LibSVM-CacheStorage", storage)
+    driver = otsvm.LibSVM()
+    driver.setSvmType(otsvm.LibSVM.EpsilonSupportRegression)
+    driver.setKernelType(otsvm.LibSVM.NormalRbf)
+    driver.setP(1e-3)
+    driver.convertData(dataIn, dataOut)
+    driver.setTradeoffFactor(100.0)
+    driver.setKernelParameter(0.25)
+    driver.performTrain()
+    ot.ResourceMap.SetAsString("LibSVM-CacheStorage", "float")
+    return driver.computeError()
+
+
+# kernel columns cached in 16-bit types: the training error stays close to
+# the one of the float cache
+reference = trainingError("float")
+ott.assert_almost_equal(trainingError("bfloat16"), reference, 5e-2, 0.0)
+ott.assert_almost_equal(trainingError("half"), reference, 1e-2, 0.0)
@@ -0,0 +1,69 @@
+#! /usr/bin/env python
+
+import openturns as ot
+import openturns.testing as ott
+import otsvm
+from math import pi
+
+# Ishigami function
+inputVariables = ["xi1", "xi2", "xi3"]
+model = ot.SymbolicFunction(
+    inputVariables, ["sin(xi1) + 7.0 * sin(xi2)^2 + 0.1 * xi3^4 * sin(xi1)"]
+)
+distribution = ot.JointDistribution([ot.Uniform(-pi, pi)] * 3)
+ot.RandomGenerator.SetSeed(0)
+dataIn = distribution.getSample(250)
+dataOut = model(dataIn)
+
+
+def train(cp, sigma):
+    ot.RandomGenerator.SetSeed(42)
+    algo = otsvm.SVMRegression(dataIn, dataOut, otsvm.LibSVM.NormalRbf)
+    algo.setTradeoffFactor(cp)
+    algo.setKernelParameter(sigma)
+    algo.run()
+    return algo.getResult().getMetaModel()(dataIn)
+
+
+cp = [500.0, 200.0, 150.0]
+sigma = [0.15, 0.25, 0.35]
+reference = train(cp, sigma)
+
+# the size of the kernel cache does not change the model
+adaptive = ot.ResourceMap.GetAsBool("LibSVM-AdaptiveCacheSize")
+budget = ot.ResourceMap.GetAsUnsignedInteger("LibSVM-MemoryBudget")
+for adaptiveCache, memoryBudget in [(True, 1), (False, 1024)]:
+    ot.ResourceMap.SetAsBool("LibSVM-AdaptiveCacheSize", adaptiveCache)
+    ot.ResourceMap.SetAsUnsignedInteger("LibSVM-MemoryBudget", memoryBudget)
+    assert train(cp, sigma) == reference, "the model must not depend on the cache size"
+ot.ResourceMap.SetAsBool("LibSVM-AdaptiveCacheSize", adaptive)
+ot.ResourceMap.SetAsUnsignedInteger("LibSVM-MemoryBudget", budget)
+
+# the cross validation folds only depend on the seed, not on the threads:
+# the model matches the one of a serial run
+threadNumber = ot.TBB.GetNumberOfThreads()
+ot.TBB.SetNumberOfThreads(1)
+serial = train(cp, sigma)
+ot.TBB.SetNumberOfThreads(threadNumber)
+assert serial == reference, "the model must not depend on the threads"
+
+# the Gram matrix shared by the tradeoff factors of a gamma holds the values
+# of the solver's own kernel: the selection does not depend on it
+cp = [500.0, 200.0, 150.0, 100.0, 10.0]
+sigma = [0.15, 0.25, 0.35, 1.0, 10.0]
+shared = train(cp, sigma)
+cacheSize = ot.ResourceMap.GetAsUnsignedInteger("LibSVM-GridCacheSize")
+ot.ResourceMap.SetAsUnsignedInteger("LibSVM-GridCacheSize", 0)
+unshared = train(cp, sigma)
+ot.ResourceMap.SetAsUnsignedInteger("LibSVM-GridCacheSize", cacheSize)
+assert shared == unshared, "the model must not depend on the grid cache"
+
+# the tradeoff factors trained along a warm-started regularization path
+# converge to the solutions of the cold starts, up to the solver tolerance
+cp = [500.0, 200.0, 150.0, 100.0, 75.0, 50.0, 10.0]
+sigma = [0.15, 0.25, 0.35, 0.5, 1.0]
+cold = train(cp, sigma)
+ot.ResourceMap.SetAsBool("LibSVM-RegularizationPath", True)
+path = train(cp, sigma)
+ot.ResourceMap.SetAsBool("LibSVM-RegularizationPath", False)
+ott.assert_almost_equal(path, cold, 1e-2, 1e-2)
@@ -0,0 +1,59 @@
+#! /usr/bin/env python
+
+import openturns as ot
+import openturns.testing as ott
+import otsvm
+from math import pi
+
+# Ishigami function and a second output
+inputVariables = ["xi1", "xi2", "xi3"]
+model = ot.SymbolicFunction(
+    inputVariables,
+    ["sin(xi1) + 7.0 * sin(xi2)^2 + 0.1 * xi3^4 * sin(xi1)", "xi1 + xi2 * xi3"],
+)
+distribution = ot.JointDistribution([ot.Uniform(-pi, pi)] * 3)
+ot.RandomGenerator.SetSeed(0)
+dataIn = distribution.getSample(250)
+dataOut = model(dataIn)
+
+cp = [500.0, 200.0, 150.0]
+sigma = [0.15, 0.25, 0.35]
+
+
+def train(outputSample, kernel):
+    ot.RandomGenerator.SetSeed(7)
+    algo = otsvm.SVMRegression(dataIn, outputSample, kernel)
+    algo.setTradeoffFactor(cp)
+    algo.setKernelParameter(sigma)
+    algo.run()
+    return algo.getResult().getMetaModel()(dataIn)
+
+
+# the outputs trained at once match the outputs trained one by one
+joint = train(dataOut, otsvm.LibSVM.NormalRbf)
+for j in range(2):
+    marginal = train(dataOut.getMarginal(j), otsvm.LibSVM.NormalRbf)
+    ott.assert_almost_equal(joint.getMarginal(j), marginal)
+
+
+def driver(outputSample):
+    svm = otsvm.LibSVM()
+    svm.setSvmType(otsvm.LibSVM.EpsilonSupportRegression)
+    svm.setKernel(otsvm.ExponentialRBF())
+    svm.convertData(dataIn, outputSample)
+    return svm
+
+
+# with a precomputed kernel, the error of each output is computed on the Gram
+# matrix of its own kernel parameter
+tradeoff = [100.0, 10.0]
+parameter = [0.5, 2.0]
+svm = driver(dataOut)
+svm.performTrain(tradeoff, parameter)
+for j in range(2):
+    svm.selectOutput(j)
+    single = driver(dataOut.getMarginal(j))
+    single.setTradeoffFactor(tradeoff[j])
+    single.setKernelParameter(parameter[j])
+    single.performTrain()
+    ott.assert_almost_equal(svm.computeError(), single.computeError())
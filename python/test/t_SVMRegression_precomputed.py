@@ -0,0 +1,60 @@
+#! /usr/bin/env python
+
+import openturns as ot
+import openturns.testing as ott
+import otsvm
+from math import pi
+
+# Ishigami function
+inputVariables = ["xi1", "xi2", "xi3"]
+model = ot.SymbolicFunction(
+    inputVariables, ["sin(xi1) + 7.0 * sin(xi2)^2 + 0.1 * xi3^4 * sin(xi1)"]
+)
+distribution = ot.JointDistribution([ot.Uniform(-pi, pi)] * 3)
+ot.RandomGenerator.SetSeed(0)
+dataIn = distribution.getSample(250)
+dataOut = model(dataIn)
+
+cp = [200.0, 100.0, 10.0]
+sigma = [0.5, 1.0, 2.0]
+
+
+def train(kernel, tradeoff, parameter, seed=0):
+    ot.RandomGenerator.SetSeed(seed)
+    algo = otsvm.SVMRegression(dataIn, dataOut, kernel)
+    algo.setTradeoffFactor(tradeoff)
+    algo.setKernelParameter(parameter)
+    algo.run()
+    return algo.getResult().getMetaModel()(dataIn)
+
+
+# the Gaussian kernel trained through its Gram matrix matches libsvm's own:
+# the grid is sigma in both modes
+native = train(otsvm.LibSVM.NormalRbf, cp, sigma)
+precomputed = train(otsvm.NormalRBF(), cp, sigma)
+ott.assert_almost_equal(precomputed, native, 1e-2, 1e-2)
+
+# a kernel without libsvm counterpart: the single precision Gram matrix gives
+# the model of the double precision one
+double = train(otsvm.ExponentialRBF(), [100.0], [1.0])
+ot.ResourceMap.SetAsString("LibSVM-GramStorage", "float")
+single = train(otsvm.ExponentialRBF(), [100.0], [1.0])
+ot.ResourceMap.SetAsString("LibSVM-GramStorage", "double")
+ott.assert_almost_equal(single, double, 1e-3, 1e-3)
+
+# the grid replaces the first kernel parameter, the degree of the polynomial
+# kernel: the selected model is the one of one of the degrees
+grid = train(otsvm.PolynomialKernel(3.0, 0.5, 1.0), [10.0], [2.0, 4.0])
+byDegree = [
+    train(otsvm.PolynomialKernel(degree, 0.5, 1.0), [10.0], [degree])
+    for degree in [2.0, 4.0]
+]
+assert grid in byDegree, "the grid must select one of the degrees"
+
+# ... and the linear term of the sigmoid kernel
+grid = train(otsvm.SigmoidKernel(0.1, 0.0), [10.0], [0.01, 0.1])
+byLinear = [
+    train(otsvm.SigmoidKernel(linear, 0.0), [10.0], [linear])
+    for linear in [0.01, 0.1]
+]
+assert grid in byLinear, "the grid must select one of the linear terms"